@@ -0,0 +1,658 @@
+#include <string.h>
+#include <ctype.h>
+#include "Assembler.h"
+
+#define MAX_OPERANDS 4
+#define INITIAL_LABELS 64
+#define INITIAL_FIXUPS 64
+
+/* Perfect hash of the mnemonics: no two opcodes share a slot, so a lookup
+   is one hash and one string compare. The multipliers were found by search,
+   they must be searched again when an opcode is added. */
+#define OPCODE_HASH_SIZE 64
+#define OPCODE_HASH(s, n) ((((unsigned char)(s)[0] * 3u) + ((unsigned char)(s)[1] * 10u) + \
+                            ((unsigned char)(s)[(n) - 1] * 27u) + (unsigned int)(n)) & (OPCODE_HASH_SIZE - 1))
+
+typedef struct
+{
+	const char* name;
+	opcode op;
+} OpcodeEntry;
+
+static const OpcodeEntry opcodeTable[OPCODE_HASH_SIZE] =
+{
+	{ "mul", MUL }, { NULL, NONE }, { "halt", HALT }, { NULL, NONE },
+	{ "sub", SUB }, { NULL, NONE }, { "beq", BEQ }, { "xor", XOR },
+	{ "ble", BLE }, { "or", OR }, { NULL, NONE }, { "sra", SRA },
+	{ "fadd", FADD }, { NULL, NONE }, { "sw", SW }, { "roi_begin", ROI_BEGIN },
+	{ "fence", FENCE }, { NULL, NONE }, { NULL, NONE }, { "swap", SWAP },
+	{ NULL, NONE }, { NULL, NONE }, { "bge", BGE }, { "cas", CAS },
+	{ NULL, NONE }, { NULL, NONE }, { "add", ADD }, { NULL, NONE },
+	{ "bne", BNE }, { "blt", BLT }, { NULL, NONE }, { NULL, NONE },
+	{ NULL, NONE }, { NULL, NONE }, { "ll", LL }, { NULL, NONE },
+	{ NULL, NONE }, { NULL, NONE }, { NULL, NONE }, { NULL, NONE },
+	{ "stats_reset", STATS_RESET }, { NULL, NONE }, { "sc", SC }, { "bgt", BGT },
+	{ NULL, NONE }, { NULL, NONE }, { NULL, NONE }, { "jal", JAL },
+	{ NULL, NONE }, { NULL, NONE }, { NULL, NONE }, { NULL, NONE },
+	{ "srl", SRL }, { NULL, NONE }, { NULL, NONE }, { NULL, NONE },
+	{ "sll", SLL }, { "lw", LW }, { NULL, NONE }, { "stats_dump", STATS_DUMP },
+	{ NULL, NONE }, { NULL, NONE }, { "and", AND }, { "roi_end", ROI_END }
+};
+
+typedef enum { RegOperand, ImmOperand, LabelOperand } OperandKind;
+
+typedef struct
+{
+	OperandKind kind;
+	int value;              /* Register number or immediate */
+	const char* name;       /* Label name, points into the source */
+	int length;
+} Operand;
+
+typedef struct
+{
+	const char* name;       /* Points into the source, not terminated */
+	int length;
+	int address;            /* -1 while only referenced */
+	int line;
+} Label;
+
+/* Branch or JAL waiting for the address of a label */
+typedef struct
+{
+	int pc;
+	int label;              /* Index in the label table */
+	int line;
+} Fixup;
+
+typedef struct
+{
+	Program prog;
+	const char* sourceName;
+	int line;
+	int numErrors;
+	bool sawHalt;           /* haltIndex is the first halt of the program */
+	Label* labels;          /* Open addressing hash table */
+	int labelCapacity;
+	int numLabels;
+	Fixup* fixups;
+	int fixupCapacity;
+	int numFixups;
+} Assembler;
+
+void asmError(Assembler* as, const char* message, const char* token, int length)
+{
+	if (token != NULL)
+		fprintf(stderr, "%s:%d: error: %s '%.*s'\n", as->sourceName, as->line, message, length, token);
+	else
+		fprintf(stderr, "%s:%d: error: %s\n", as->sourceName, as->line, message);
+	as->numErrors++;
+}
+
+opcode lookupOpcode(const char* name, int length)
+{
+	const OpcodeEntry* entry;
+
+	if (length < 2)
+		return NONE;
+
+	entry = &opcodeTable[OPCODE_HASH(name, length)];
+	if (entry->name != NULL && strncmp(entry->name, name, length) == 0 && entry->name[length] == '\0')
+		return entry->op;
+
+	return NONE;
+}
+
+const char* getOpcodeName(opcode op)
+{
+	int i;
+
+	for (i = 0; i < OPCODE_HASH_SIZE; i++)
+		if (opcodeTable[i].name != NULL && opcodeTable[i].op == op)
+			return opcodeTable[i].name;
+
+	return "?";
+}
+
+void disassembleInstruction(const Instruction* inst, char* text, int size)
+{
+	const char* name = getOpcodeName(inst->op);
+
+	if (inst->type == Reg || inst->type == STR)
+	{
+		if (inst->hasImm)
+			snprintf(text, size, "%s $r%d, $r%d, %d", name, inst->rd, inst->rs, inst->imm);
+		else
+			snprintf(text, size, "%s $r%d, $r%d, $r%d", name, inst->rd, inst->rs, inst->rt);
+	}
+	else if (inst->type == B)
+		snprintf(text, size, "%s $r%d, $r%d, $r%d, %d", name, inst->rd, inst->rs, inst->rt, inst->imm);
+	else if (inst->type == J)
+		snprintf(text, size, "%s %d", name, inst->imm);
+	else
+		snprintf(text, size, "%s", name);
+}
+
+opcode stringToOpcode(char* name)
+{
+	return lookupOpcode(name, (int)strlen(name));
+}
+
+unsigned int hashLabel(const char* name, int length)
+{
+	unsigned int hash = 2166136261u;
+	int i;
+
+	for (i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)name[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+int growLabels(Assembler* as);
+
+// Index of the label in the table, inserted as undefined when new. -1 on allocation failure.
+int findLabel(Assembler* as, const char* name, int length)
+{
+	unsigned int mask, i;
+	Label* label;
+
+	if (2 * (as->numLabels + 1) > as->labelCapacity && !growLabels(as))
+		return -1;
+
+	mask = (unsigned int)as->labelCapacity - 1;
+	for (i = hashLabel(name, length) & mask; ; i = (i + 1) & mask)
+	{
+		label = &as->labels[i];
+		if (label->name == NULL)
+		{
+			label->name = name;
+			label->length = length;
+			label->address = -1;
+			label->line = as->line;
+			as->numLabels++;
+			return (int)i;
+		}
+		if (label->length == length && memcmp(label->name, name, length) == 0)
+			return (int)i;
+	}
+}
+
+// Double the label table. Fixups refer to labels by index, so they are moved along.
+int growLabels(Assembler* as)
+{
+	Label* old = as->labels;
+	int oldCapacity = as->labelCapacity;
+	int* moved;
+	int i, j;
+
+	as->labelCapacity = (oldCapacity == 0) ? INITIAL_LABELS : 2 * oldCapacity;
+	as->labels = (Label*)calloc(as->labelCapacity, sizeof(Label));
+	moved = (int*)malloc((oldCapacity + 1) * sizeof(int));
+	if (as->labels == NULL || moved == NULL)
+	{
+		free(as->labels);
+		free(moved);
+		as->labels = old;
+		as->labelCapacity = oldCapacity;
+		return 0;
+	}
+
+	as->numLabels = 0;
+	for (i = 0; i < oldCapacity; i++)
+	{
+		moved[i] = -1;
+		if (old[i].name == NULL)
+			continue;
+		j = findLabel(as, old[i].name, old[i].length);
+		as->labels[j] = old[i];
+		moved[i] = j;
+	}
+	for (i = 0; i < as->numFixups; i++)
+		as->fixups[i].label = moved[as->fixups[i].label];
+
+	free(moved);
+	free(old);
+	return 1;
+}
+
+int addFixup(Assembler* as, int pc, int label)
+{
+	Fixup* fixups;
+
+	if (as->numFixups == as->fixupCapacity)
+	{
+		as->fixupCapacity = (as->fixupCapacity == 0) ? INITIAL_FIXUPS : 2 * as->fixupCapacity;
+		fixups = (Fixup*)realloc(as->fixups, as->fixupCapacity * sizeof(Fixup));
+		if (fixups == NULL)
+			return 0;
+		as->fixups = fixups;
+	}
+	as->fixups[as->numFixups].pc = pc;
+	as->fixups[as->numFixups].label = label;
+	as->fixups[as->numFixups].line = as->line;
+	as->numFixups++;
+	return 1;
+}
+
+// Next free instruction of the program, the instruction memory grows as needed
+Instruction* appendInstruction(Program prog)
+{
+	Instruction* instructions;
+	int capacity;
+
+	if (prog->numInstructions == prog->capacity)
+	{
+		capacity = 2 * prog->capacity;
+		instructions = (Instruction*)realloc(prog->instructions, capacity * sizeof(Instruction));
+		if (instructions == NULL)
+			return NULL;
+		prog->instructions = instructions;
+		prog->capacity = capacity;
+	}
+
+	instructions = &prog->instructions[prog->numInstructions++];
+	memset(instructions, 0, sizeof(Instruction));
+	return instructions;
+}
+
+bool isLabelChar(char c)
+{
+	return isalnum((unsigned char)c) || c == '_' || c == '.';
+}
+
+// Parse one operand starting at p, returns the position after it or NULL on error
+const char* parseOperand(Assembler* as, const char* p, const char* end, Operand* operand)
+{
+	const char* start = p;
+	int value = 0, base = 10, digit;
+	bool negative = False;
+
+	if (*p == '$') /* Register: $r0-$r15, $R0-$R15 or $0-$15 */
+	{
+		p++;
+		if (p < end && (*p == 'r' || *p == 'R'))
+			p++;
+		if (p == end || !isdigit((unsigned char)*p))
+		{
+			asmError(as, "invalid register", start, (int)(p - start));
+			return NULL;
+		}
+		while (p < end && isdigit((unsigned char)*p) && value < NUM_REGS)
+			value = 10 * value + (*p++ - '0');
+		if (value >= NUM_REGS || (p < end && isLabelChar(*p)))
+		{
+			while (p < end && isLabelChar(*p))
+				p++;
+			asmError(as, "invalid register", start, (int)(p - start));
+			return NULL;
+		}
+		operand->kind = RegOperand;
+		operand->value = value;
+		return p;
+	}
+
+	if (*p == '-' || isdigit((unsigned char)*p)) /* Decimal or 0x hexadecimal immediate */
+	{
+		if (*p == '-')
+		{
+			negative = True;
+			p++;
+		}
+		if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+		{
+			base = 16;
+			p += 2;
+		}
+		if (p == end || !isxdigit((unsigned char)*p))
+		{
+			asmError(as, "invalid immediate", start, (int)(p - start));
+			return NULL;
+		}
+		for (; p < end && isalnum((unsigned char)*p); p++)
+		{
+			if (isdigit((unsigned char)*p))
+				digit = *p - '0';
+			else
+				digit = tolower((unsigned char)*p) - 'a' + 10;
+			if (digit >= base || value > (0x7FFFFFFF - digit) / base)
+			{
+				while (p < end && isalnum((unsigned char)*p))
+					p++;
+				asmError(as, "invalid immediate", start, (int)(p - start));
+				return NULL;
+			}
+			value = value * base + digit;
+		}
+		operand->kind = ImmOperand;
+		operand->value = negative ? -value : value;
+		return p;
+	}
+
+	if (isLabelChar(*p)) /* Label */
+	{
+		while (p < end && isLabelChar(*p))
+			p++;
+		operand->kind = LabelOperand;
+		operand->name = start;
+		operand->length = (int)(p - start);
+		return p;
+	}
+
+	asmError(as, "unexpected character", p, 1);
+	return NULL;
+}
+
+// Check an operand is a register and return it, -1 when it is not
+int operandRegister(Assembler* as, const Operand* operand)
+{
+	if (operand->kind != RegOperand)
+	{
+		asmError(as, "expected a register", NULL, 0);
+		return -1;
+	}
+	return operand->value;
+}
+
+// Fill the target of a branch or JAL, labels that are not defined yet get a fixup
+void setTarget(Assembler* as, Instruction* inst, const Operand* operand)
+{
+	int label;
+
+	if (operand->kind == ImmOperand)
+	{
+		inst->imm = operand->value;
+		return;
+	}
+	if (operand->kind != LabelOperand)
+	{
+		asmError(as, "expected a label or an address", NULL, 0);
+		return;
+	}
+
+	label = findLabel(as, operand->name, operand->length);
+	if (label < 0 || !addFixup(as, as->prog->numInstructions - 1, label))
+		asmError(as, "out of memory", NULL, 0);
+}
+
+void assembleInstruction(Assembler* as, opcode op, Operand operands[], int numOperands)
+{
+	Instruction* inst = appendInstruction(as->prog);
+
+	if (inst == NULL)
+	{
+		asmError(as, "out of memory", NULL, 0);
+		return;
+	}
+	inst->op = op;
+	inst->rs = -1;
+	inst->rt = -1;
+	inst->rd = -1;
+
+	if (isRegularType(op) || isStore(op) || isAtomic(op)) /* op rd, rs, rt|imm */
+	{
+		inst->type = (isStore(op) || isAtomic(op)) ? STR : Reg;
+		if (numOperands != 3)
+		{
+			asmError(as, "expected rd, rs, rt or rd, rs, immediate", NULL, 0);
+			return;
+		}
+		inst->rd = operandRegister(as, &operands[0]);
+		inst->rs = operandRegister(as, &operands[1]);
+		if (operands[2].kind == RegOperand)
+		{
+			inst->rt = operands[2].value;
+			inst->imm = -1;
+		}
+		else if (operands[2].kind == ImmOperand)
+		{
+			if (operands[2].value > (1 << 11) - 1 || operands[2].value < -(1 << 11))
+				asmError(as, "immediate does not fit in 12 bits", NULL, 0);
+			inst->imm = operands[2].value;
+			inst->hasImm = True;
+		}
+		else
+			asmError(as, "expected a register or an immediate", operands[2].name, operands[2].length);
+
+		if (inst->rd == 1 && (inst->type == Reg || hasMemoryResult(op)))
+			asmError(as, "destination register cannot be R1", NULL, 0);
+		if (op == CAS && inst->hasImm)
+			asmError(as, "cas compares with a register, not an immediate", NULL, 0);
+	}
+	else if (isBranch(op)) /* op rd, rs, rt, target */
+	{
+		inst->type = B;
+		if (numOperands != 4)
+		{
+			asmError(as, "expected rd, rs, rt, target", NULL, 0);
+			return;
+		}
+		inst->rs = operandRegister(as, &operands[1]);
+		inst->rt = operandRegister(as, &operands[2]);
+		inst->rd = 1; // Register 1
+		inst->hasImm = True;
+		setTarget(as, inst, &operands[3]);
+	}
+	else if (isJal(op)) /* jal target */
+	{
+		inst->type = J;
+		if (numOperands != 1)
+		{
+			asmError(as, "expected a target", NULL, 0);
+			return;
+		}
+		inst->rd = 15;  // Return address register
+		inst->hasImm = True;
+		setTarget(as, inst, &operands[0]);
+	}
+	else if (isFence(op)) /* fence */
+	{
+		inst->type = FNC;
+		if (numOperands != 0)
+			asmError(as, "fence takes no operands", NULL, 0);
+	}
+	else if (isStatsControl(op)) /* roi_begin, roi_end, stats_reset, stats_dump */
+	{
+		inst->type = CTL;
+		if (numOperands != 0)
+			asmError(as, "statistics control takes no operands", NULL, 0);
+	}
+	else /* halt */
+	{
+		inst->type = H;
+		inst->isHalt = True;
+		if (numOperands != 0)
+			asmError(as, "halt takes no operands", NULL, 0);
+		if (!as->sawHalt)
+			as->prog->haltIndex = as->prog->numInstructions - 1;
+		as->sawHalt = True;
+	}
+}
+
+void assembleLine(Assembler* as, const char* p, const char* end)
+{
+	const char* word;
+	Operand operands[MAX_OPERANDS];
+	int numOperands = 0, label;
+	opcode op;
+
+	while (p < end && isspace((unsigned char)*p))
+		p++;
+	if (p == end || *p == ';')
+		return;
+
+	word = p;
+	while (p < end && isLabelChar(*p))
+		p++;
+
+	/* Label definition */
+	if (p < end && *p == ':' && p > word)
+	{
+		label = findLabel(as, word, (int)(p - word));
+		if (label < 0)
+			asmError(as, "out of memory", NULL, 0);
+		else if (as->labels[label].address >= 0)
+			asmError(as, "label defined twice", word, (int)(p - word));
+		else
+		{
+			as->labels[label].address = as->prog->numInstructions;
+			as->labels[label].line = as->line;
+		}
+
+		for (p++; p < end && isspace((unsigned char)*p); p++)
+			;
+		if (p == end || *p == ';')
+			return;
+		word = p;
+		while (p < end && isLabelChar(*p))
+			p++;
+	}
+
+	op = lookupOpcode(word, (int)(p - word));
+	if (op == NONE)
+	{
+		asmError(as, "unknown opcode", word, (p > word) ? (int)(p - word) : 1);
+		return;
+	}
+
+	/* Operands separated by commas */
+	while (True)
+	{
+		while (p < end && isspace((unsigned char)*p))
+			p++;
+		if (p == end || *p == ';')
+			break;
+		if (numOperands > 0)
+		{
+			if (*p != ',')
+			{
+				asmError(as, "expected ',' before", p, 1);
+				return;
+			}
+			for (p++; p < end && isspace((unsigned char)*p); p++)
+				;
+			if (p == end || *p == ';')
+			{
+				asmError(as, "missing operand", NULL, 0);
+				return;
+			}
+		}
+		if (numOperands == MAX_OPERANDS)
+		{
+			asmError(as, "too many operands", NULL, 0);
+			return;
+		}
+		p = parseOperand(as, p, end, &operands[numOperands]);
+		if (p == NULL)
+			return;
+		numOperands++;
+	}
+
+	assembleInstruction(as, op, operands, numOperands);
+}
+
+// Patch label references and check every target is inside the program
+void resolveTargets(Assembler* as)
+{
+	int i;
+	Label* label;
+	Instruction* inst;
+
+	for (i = 0; i < as->numFixups; i++)
+	{
+		label = &as->labels[as->fixups[i].label];
+		as->line = as->fixups[i].line;
+		if (label->address < 0)
+			asmError(as, "undefined label", label->name, label->length);
+		else
+			as->prog->instructions[as->fixups[i].pc].imm = label->address;
+	}
+
+	for (i = 0; i < as->prog->numInstructions; i++)
+	{
+		inst = &as->prog->instructions[i];
+		if ((inst->type == B || inst->type == J) && (inst->imm < 0 || inst->imm >= as->prog->numInstructions))
+		{
+			fprintf(stderr, "%s: error: target %d of instruction %d is outside the program\n", as->sourceName, inst->imm, i);
+			as->numErrors++;
+		}
+	}
+}
+
+int assembleProgram(Program prog, const char* source, size_t length, const char* sourceName)
+{
+	Assembler as;
+	const char* end = source + length;
+	const char* lineEnd;
+	Instruction* halt;
+
+	memset(&as, 0, sizeof(as));
+	as.prog = prog;
+	as.sourceName = sourceName;
+
+	while (source < end)
+	{
+		as.line++;
+		lineEnd = memchr(source, '\n', end - source);
+		if (lineEnd == NULL)
+			lineEnd = end;
+		assembleLine(&as, source, lineEnd);
+		source = lineEnd + 1;
+	}
+
+	/* A program never runs off its end, fetch stops at a halt */
+	if (prog->numInstructions == 0 || prog->instructions[prog->numInstructions - 1].op != HALT)
+	{
+		halt = appendInstruction(prog);
+		if (halt == NULL)
+			asmError(&as, "out of memory", NULL, 0);
+		else
+		{
+			halt->type = H;
+			halt->op = HALT;
+			halt->rs = halt->rt = halt->rd = -1;
+			halt->isHalt = True;
+			if (!as.sawHalt)
+				prog->haltIndex = prog->numInstructions - 1;
+		}
+	}
+
+	resolveTargets(&as);
+
+	free(as.labels);
+	free(as.fixups);
+	return as.numErrors;
+}
+
+int assembleFile(Program prog, char* fileName)
+{
+	FILE* file = fopen(fileName, "rb");
+	char* source;
+	long length;
+	int errors;
+
+	if (file == NULL)
+	{
+		fprintf(stderr, "Could not open program file %s.\n", fileName);
+		return 1;
+	}
+
+	fseek(file, 0, SEEK_END);
+	length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+	source = (char*)malloc(length > 0 ? length : 1);
+	if (source == NULL || fread(source, 1, length, file) != (size_t)length)
+	{
+		fprintf(stderr, "Could not read program file %s.\n", fileName);
+		free(source);
+		fclose(file);
+		return 1;
+	}
+	fclose(file);
+
+	errors = assembleProgram(prog, source, (size_t)length, fileName);
+	free(source);
+	return errors;
+}
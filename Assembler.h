@@ -0,0 +1,41 @@
+#ifndef ASSEMBLER_H
+#define ASSEMBLER_H
+
+#include "Shared.h"
+#include "Pipeline2.h"
+
+/* Assembler
+ *
+ * Translates assembly source into a Program in a single pass over the text.
+ * Branch and JAL targets may name labels defined anywhere in the program;
+ * references to labels not defined yet are patched once the pass is over.
+ *
+ *   loop:   add  $r3, $r3, $r2          ; rd, rs, rt
+ *           sub  $r2, $r2, 1            ; rt may be an immediate
+ *           bne  $r1, $r2, $r0, loop    ; target is a label or an address
+ *           jal  done
+ *   done:   halt
+ *
+ * Errors are reported on stderr as "name:line: error: message" and the pass
+ * continues so that every error of the source is reported at once.
+ * A program that does not end in a halt gets one appended.
+ */
+
+/* Assemble source text of the given length into an empty program.
+   sourceName is only used in diagnostics. Returns the number of errors. */
+int assembleProgram(Program prog, const char* source, size_t length, const char* sourceName);
+
+/* Assemble a source file into an empty program, returns the number of errors
+   (1 when the file cannot be read). */
+int assembleFile(Program prog, char* fileName);
+
+/* Opcode of a mnemonic of the given length, NONE when unknown */
+opcode lookupOpcode(const char* name, int length);
+
+/* Mnemonic of an opcode, "?" when unknown */
+const char* getOpcodeName(opcode op);
+
+/* Write an instruction as assembly source, targets as addresses */
+void disassembleInstruction(const Instruction* inst, char* text, int size);
+
+#endif
@@ -0,0 +1,175 @@
+#include <string.h>
+#include <time.h>
+#include "Bench.h"
+#include "Pipeline2.h"
+#include "Assembler.h"
+#include "Simulator.h"
+#include "Functional.h"
+
+#define BENCH_LINE_LEN 64
+#define BENCH_MIN_SECONDS 0.5      /* Repeat a run until it takes at least this long */
+
+double benchTime()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Generate numLines of source, every 8th line starts a labelled block ending in a branch back to it
+char* generateBenchSource(int numLines, size_t* length)
+{
+	static const char* body[] =
+	{
+		"        add $r2, $r3, $r4\n",
+		"        sub $r5, $r2, 17        ; comment\n",
+		"        lw $r6, $r5, 0x10\n",
+		"        sw $r6, $r5, $r0\n",
+		"        xor $r7, $r6, $r2\n",
+		"        sll $r8, $r7, 3\n"
+	};
+	char* source = (char*)malloc((size_t)numLines * BENCH_LINE_LEN + 1);
+	char* p = source;
+	int i, block = 0;
+
+	if (source == NULL)
+		return NULL;
+
+	for (i = 0; i < numLines - 1; i++)
+	{
+		if (i % 8 == 0)
+			p += sprintf(p, "L%d:     mul $r9, $r9, $r2\n", ++block);
+		else if (i % 8 == 7)
+			p += sprintf(p, "        bne $r1, $r2, $r0, L%d\n", block);
+		else
+		{
+			strcpy(p, body[i % 6]);
+			p += strlen(p);
+		}
+	}
+	strcpy(p, "        halt\n");
+	p += strlen(p);
+
+	*length = (size_t)(p - source);
+	return source;
+}
+
+int benchAssembler(int numLines)
+{
+	char* source;
+	size_t length;
+	Program prog;
+	double start, elapsed;
+	int runs = 0, errors = 0;
+
+	if (numLines < 1 || (source = generateBenchSource(numLines, &length)) == NULL)
+	{
+		fprintf(stderr, "Could not generate %d lines of source.\n", numLines);
+		return 0;
+	}
+
+	start = benchTime();
+	do
+	{
+		if ((prog = createProgram()) == NULL)
+			break;
+		errors += assembleProgram(prog, source, length, "<bench>");
+		destroyProgram(prog);
+		runs++;
+		elapsed = benchTime() - start;
+	} while (errors == 0 && elapsed < BENCH_MIN_SECONDS);
+
+	free(source);
+	if (prog == NULL || errors != 0)
+		return 0;
+
+	printf("assembler: %d lines x %d runs in %.3f s, %.0f lines/s, %.1f MB/s\n", numLines, runs, elapsed,
+		   (double)numLines * runs / elapsed, (double)length * runs / elapsed / 1e6);
+	return 1;
+}
+
+/* Each core works on its own words, so the caches only miss once */
+static const char* benchKernel =
+	"        add $r2, $r0, %d\n"
+	"        sll $r2, $r2, 11\n"
+	"        add $r2, $r2, %d\n"
+	"        add $r3, $r0, %d\n"
+	"loop:   lw $r4, $r3, 0\n"
+	"        add $r5, $r4, $r2\n"
+	"        mul $r6, $r5, 3\n"
+	"        xor $r7, $r6, $r5\n"
+	"        srl $r8, $r7, 2\n"
+	"        sw $r8, $r3, 1\n"
+	"        sub $r2, $r2, 1\n"
+	"        bne $r1, $r2, $r0, loop\n"
+	"        halt\n";
+
+// Create a simulation running the kernel for the given iterations on every core
+SimHandle createBenchSimulation(int iterations, const SimConfig* config)
+{
+	char sources[NUM_CORES][512];
+	const char* programs[NUM_CORES];
+	int i;
+
+	if (iterations < 1 || iterations >= (1 << 22))
+	{
+		fprintf(stderr, "Benchmark iterations must be between 1 and %d.\n", (1 << 22) - 1);
+		return NULL;
+	}
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		sprintf(sources[i], benchKernel, iterations >> 11, iterations & 0x7FF, 16 * i);
+		programs[i] = sources[i];
+	}
+	return simCreate(config, programs);
+}
+
+int benchSimulator(int iterations)
+{
+	SimConfig config;
+	SimStats stats;
+	SimHandle sim;
+	double start, elapsed;
+	long long instructions = 0;
+	int i;
+
+	simGetDefaultConfig(&config);
+	if ((sim = createBenchSimulation(iterations, &config)) == NULL)
+		return 0;
+
+	start = benchTime();
+	simRun(sim);
+	elapsed = benchTime() - start;
+
+	simGetStats(sim, &stats);
+	for (i = 0; i < NUM_CORES; i++)
+		instructions += stats.cores[i].instructions;
+	simDestroy(sim);
+
+	printf("simulator: %lld instructions in %d cycles, %.3f s, %.2f M instructions/s, %.2f M cycles/s\n",
+		   instructions, stats.cycles, elapsed, instructions / elapsed / 1e6, stats.cycles / elapsed / 1e6);
+	return 1;
+}
+
+int benchFunctional(int iterations, bool warm)
+{
+	SimConfig config;
+	SimHandle sim;
+	double start, elapsed;
+	int instructions;
+
+	simGetDefaultConfig(&config);
+	if ((sim = createBenchSimulation(iterations, &config)) == NULL)
+		return 0;
+
+	start = benchTime();
+	instructions = fastForwardComputer(sim, 0, -1, warm);
+	elapsed = benchTime() - start;
+	simDestroy(sim);
+
+	printf("functional%s: %d instructions, %.3f s, %.2f M instructions/s\n", warm ? " (warm caches)" : "",
+		   instructions, elapsed, instructions / elapsed / 1e6);
+	return 1;
+}
@@ -0,0 +1,24 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "Shared.h"
+
+/* Host throughput benchmarks of the simulator itself, results are printed
+   on stdout. Each returns 1 on success and 0 on failure. */
+
+/* Assemble a generated program of the given number of lines (a mix of ALU,
+   memory and branch instructions with labels) and report lines per second */
+int benchAssembler(int numLines);
+
+/* Run the same loop of ALU, load/store and branch instructions on every core
+   of the detailed pipeline model and report simulated instructions per second */
+int benchSimulator(int iterations);
+
+/* Run the same loop with the functional engine used to fast-forward and
+   report simulated instructions per second, with or without cache warming */
+int benchFunctional(int iterations, bool warm);
+
+/* Wall clock time in seconds */
+double benchTime();
+
+#endif
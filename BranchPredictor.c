@@ -0,0 +1,81 @@
+#include <string.h>
+#include "BranchPredictor.h"
+
+#define COUNTER_MAX 3
+#define COUNTER_TAKEN 2         /* Counters at or above predict taken */
+
+BranchPredictor createBranchPredictor(PredictorScheme scheme)
+{
+	BranchPredictor bp = (BranchPredictor)malloc(sizeof(struct BranchPredictor_));
+
+	if (bp == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for branch predictor.\n");
+		return NULL;
+	}
+
+	bp->scheme = scheme;
+	memset(bp->btb, 0, sizeof(bp->btb));
+	memset(bp->counters, COUNTER_TAKEN - 1, sizeof(bp->counters)); // Weakly not taken
+	bp->history = 0;
+	return bp;
+}
+
+void destroyBranchPredictor(BranchPredictor bp)
+{
+	free(bp);
+}
+
+unsigned int getCounterIndex(BranchPredictor bp, int pc)
+{
+	if (bp->scheme == PredictGshare)
+		return ((unsigned int)pc ^ (bp->history & ((1u << GSHARE_HISTORY_BITS) - 1))) & (PHT_ENTRIES - 1);
+
+	return (unsigned int)pc & (PHT_ENTRIES - 1);
+}
+
+bool predictBranch(BranchPredictor bp, int pc, int* target)
+{
+	BTBEntry* entry = &bp->btb[(unsigned int)pc % BTB_ENTRIES];
+	bool taken;
+
+	if (bp->scheme == PredictNotTaken || !entry->valid || entry->pc != pc)
+		return False;
+
+	if (bp->scheme == PredictBTFN)
+		taken = entry->target <= pc;
+	else
+		taken = bp->counters[getCounterIndex(bp, pc)] >= COUNTER_TAKEN;
+
+	if (taken)
+		*target = entry->target;
+	return taken;
+}
+
+void updateBranchPredictor(BranchPredictor bp, int pc, bool taken, int target)
+{
+	BTBEntry* entry = &bp->btb[(unsigned int)pc % BTB_ENTRIES];
+	unsigned char* counter = &bp->counters[getCounterIndex(bp, pc)];
+
+	if (taken)
+	{
+		entry->valid = True;
+		entry->pc = pc;
+		entry->target = target;
+		if (*counter < COUNTER_MAX)
+			(*counter)++;
+	}
+	else if (*counter > 0)
+		(*counter)--;
+
+	bp->history = (bp->history << 1) | (taken ? 1 : 0);
+}
+
+const char* getPredictorSchemeName(PredictorScheme scheme)
+{
+	static const char* names[NumPredictorSchemes] = { "not-taken", "btfn", "bimodal", "gshare" };
+
+	if (scheme < 0 || scheme >= NumPredictorSchemes)
+		return "unknown";
+	return names[scheme];
+}
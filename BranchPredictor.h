@@ -0,0 +1,46 @@
+#ifndef BRANCH_PREDICTOR_H
+#define BRANCH_PREDICTOR_H
+
+#include "Shared.h"
+
+#define BTB_ENTRIES 64          /* Direct mapped branch target buffer */
+#define PHT_ENTRIES 1024        /* 2-bit counters of the bimodal and gshare schemes */
+#define GSHARE_HISTORY_BITS 10
+
+/* Direction prediction scheme. Every scheme but PredictNotTaken takes the
+   target of a predicted taken branch from the BTB, a branch missing in the
+   BTB is predicted not taken. */
+typedef enum
+{
+	PredictNotTaken = 0,    /* No prediction, IF fetches sequentially */
+	PredictBTFN,            /* Static: backward taken, forward not taken */
+	PredictBimodal,         /* 2-bit counters indexed by PC */
+	PredictGshare,          /* 2-bit counters indexed by PC xor global history */
+	NumPredictorSchemes
+} PredictorScheme;
+
+typedef struct
+{
+	bool valid;
+	int pc;
+	int target;
+} BTBEntry;
+
+struct BranchPredictor_
+{
+	PredictorScheme scheme;
+	BTBEntry btb[BTB_ENTRIES];
+	unsigned char counters[PHT_ENTRIES];
+	unsigned int history;   /* Outcomes of the last branches, newest in bit 0 */
+};
+typedef struct BranchPredictor_* BranchPredictor;
+
+BranchPredictor createBranchPredictor(PredictorScheme scheme);
+void destroyBranchPredictor(BranchPredictor bp);
+// Predict the branch at pc, sets *target and returns True when predicted taken
+bool predictBranch(BranchPredictor bp, int pc, int* target);
+// Train with the outcome resolved in ID
+void updateBranchPredictor(BranchPredictor bp, int pc, bool taken, int target);
+const char* getPredictorSchemeName(PredictorScheme scheme);
+
+#endif
@@ -0,0 +1,930 @@
+#include <string.h>
+#include "Checkpoint.h"
+#include "ProgramImage.h"
+
+#define INITIAL_SECTION_BYTES 4096
+
+void putWord(CheckpointBuffer* buf, int word)
+{
+	unsigned char* data;
+	size_t capacity;
+	unsigned int w = (unsigned int)word;
+
+	if (buf->length + 4 > buf->capacity)
+	{
+		capacity = buf->capacity ? 2 * buf->capacity : INITIAL_SECTION_BYTES;
+		if ((data = (unsigned char*)realloc(buf->data, capacity)) == NULL)
+		{
+			buf->truncated = True; // Reported when the section is written
+			return;
+		}
+		buf->data = data;
+		buf->capacity = capacity;
+	}
+
+	buf->data[buf->length++] = (unsigned char)w;
+	buf->data[buf->length++] = (unsigned char)(w >> 8);
+	buf->data[buf->length++] = (unsigned char)(w >> 16);
+	buf->data[buf->length++] = (unsigned char)(w >> 24);
+}
+
+int getWord(CheckpointBuffer* buf)
+{
+	const unsigned char* p;
+
+	if (buf->position + 4 > buf->length)
+	{
+		buf->truncated = True;
+		return 0;
+	}
+
+	p = &buf->data[buf->position];
+	buf->position += 4;
+	return (int)((unsigned int)p[0] | ((unsigned int)p[1] << 8) | ((unsigned int)p[2] << 16) | ((unsigned int)p[3] << 24));
+}
+
+// Write the section and empty the buffer for the next one
+int writeSection(FILE* out, CheckpointSection tag, CheckpointBuffer* buf)
+{
+	CheckpointBuffer header = { NULL, 0, 0, 0, False };
+	int status;
+
+	putWord(&header, tag);
+	putWord(&header, (int)buf->length);
+	status = !header.truncated && !buf->truncated && fwrite(header.data, 1, header.length, out) == header.length &&
+			 fwrite(buf->data, 1, buf->length, out) == buf->length;
+	free(header.data);
+
+	buf->length = 0;
+	return status;
+}
+
+int readSection(FILE* in, CheckpointSection* tag, CheckpointBuffer* buf)
+{
+	unsigned char bytes[8];
+	CheckpointBuffer header = { bytes, 8, 8, 0, False };
+	size_t length;
+	unsigned char* data;
+
+	if (fread(bytes, 1, 8, in) != 8)
+		return 0;
+	*tag = (CheckpointSection)getWord(&header);
+	length = (size_t)(unsigned int)getWord(&header);
+
+	if (length > buf->capacity)
+	{
+		if ((data = (unsigned char*)realloc(buf->data, length)) == NULL)
+			return 0;
+		buf->data = data;
+		buf->capacity = length;
+	}
+	buf->length = length;
+	buf->position = 0;
+	buf->truncated = False;
+
+	return fread(buf->data, 1, length, in) == length;
+}
+
+void saveMemory(Memory mem, CheckpointBuffer* buf)
+{
+	int page, i, numPages = 0;
+
+	putWord(buf, mem->memBusy);
+	putWord(buf, mem->curOp);
+	putWord(buf, (int)mem->curAddress);
+	putWord(buf, mem->curData);
+	putWord(buf, mem->memWaitCycles);
+
+	for (page = 0; page < MEM_SIZE / CHECKPOINT_PAGE_WORDS; page++)
+		for (i = 0; i < CHECKPOINT_PAGE_WORDS; i++)
+			if (mem->data[page * CHECKPOINT_PAGE_WORDS + i] != 0)
+			{
+				numPages++;
+				break;
+			}
+
+	putWord(buf, numPages);
+	for (page = 0; page < MEM_SIZE / CHECKPOINT_PAGE_WORDS; page++)
+	{
+		for (i = 0; i < CHECKPOINT_PAGE_WORDS; i++)
+			if (mem->data[page * CHECKPOINT_PAGE_WORDS + i] != 0)
+				break;
+		if (i == CHECKPOINT_PAGE_WORDS)
+			continue;
+
+		putWord(buf, page);
+		for (i = 0; i < CHECKPOINT_PAGE_WORDS; i++)
+			putWord(buf, mem->data[page * CHECKPOINT_PAGE_WORDS + i]);
+	}
+
+	putWord(buf, mem->reads);
+	putWord(buf, mem->writes);
+}
+
+void restoreMemory(Memory mem, CheckpointBuffer* buf)
+{
+	int page, i, numPages;
+
+	mem->memBusy = (bool)getWord(buf);
+	mem->curOp = (MemOperation)getWord(buf);
+	mem->curAddress = (unsigned int)getWord(buf);
+	mem->curData = getWord(buf);
+	mem->memWaitCycles = getWord(buf);
+
+	memset(mem->data, 0, sizeof(mem->data));
+	numPages = getWord(buf);
+	while (numPages-- > 0 && !buf->truncated)
+	{
+		page = getWord(buf);
+		if (page < 0 || page >= MEM_SIZE / CHECKPOINT_PAGE_WORDS)
+		{
+			buf->truncated = True;
+			return;
+		}
+		for (i = 0; i < CHECKPOINT_PAGE_WORDS; i++)
+			mem->data[page * CHECKPOINT_PAGE_WORDS + i] = getWord(buf);
+	}
+
+	// Operation counters follow the pages since they were counted
+	if (buf->position < buf->length)
+	{
+		mem->reads = getWord(buf);
+		mem->writes = getWord(buf);
+	}
+}
+
+int compareBlockUse(const void* a, const void* b)
+{
+	return ((const CheckpointBlock*)a)->block->lastUsed - ((const CheckpointBlock*)b)->block->lastUsed;
+}
+
+void saveCache(Cache cache, CheckpointBuffer* buf)
+{
+	CheckpointBlock* valid = (CheckpointBlock*)malloc(cache->numLines * sizeof(CheckpointBlock));
+	int i, numValid = 0, numShared;
+
+	if (valid == NULL)
+	{
+		buf->truncated = True;
+		return;
+	}
+
+	for (i = 0; i < cache->numLines; i++)
+		if (cache->blocks[i]->invalid == 0)
+		{
+			valid[numValid].block = cache->blocks[i];
+			valid[numValid++].set = i / cache->associativity;
+		}
+	qsort(valid, numValid, sizeof(CheckpointBlock), compareBlockUse);
+
+	putWord(buf, cache->id);
+	putWord(buf, cache->hits);
+	putWord(buf, cache->misses);
+	putWord(buf, cache->reads);
+	putWord(buf, cache->writes);
+	putWord(buf, numValid);
+	for (i = 0; i < numValid; i++)
+	{
+		// Block address from its tag and set, least recently used first
+		putWord(buf, (btoi(valid[i].block->tag) << cache->indexBits) | valid[i].set);
+		putWord(buf, valid[i].block->modified);
+		putWord(buf, valid[i].block->data);
+	}
+	putWord(buf, cache->retryAddress);  // Added after the blocks
+
+	// Blocks whose shared bit a refill would not set, like a migratory grant held modified and shared
+	numShared = 0;
+	for (i = 0; i < numValid; i++)
+		if (valid[i].block->shared != (valid[i].block->modified ? 0 : 1))
+			numShared++;
+	putWord(buf, numShared);
+	for (i = 0; i < numValid; i++)
+		if (valid[i].block->shared != (valid[i].block->modified ? 0 : 1))
+		{
+			putWord(buf, (btoi(valid[i].block->tag) << cache->indexBits) | valid[i].set);
+			putWord(buf, valid[i].block->shared);
+		}
+	free(valid);
+}
+
+int restoreCache(Computer comp, CheckpointBuffer* buf)
+{
+	int id = getWord(buf);
+	int i, numValid, numShared, address, modified, data, evictAddr, evictData;
+	Block block;
+	Cache cache;
+
+	if (id < 0 || id >= NUM_CORES)
+		return 0;
+	cache = comp->caches[id];
+
+	for (i = 0; i < cache->numLines; i++)
+	{
+		cache->blocks[i]->invalid = 1;
+		cache->blocks[i]->modified = 0;
+		cache->blocks[i]->shared = 0;
+	}
+
+	cache->hits = getWord(buf);
+	cache->misses = getWord(buf);
+	cache->reads = getWord(buf);
+	cache->writes = getWord(buf);
+	numValid = getWord(buf);
+	for (i = 0; i < numValid && !buf->truncated; i++)
+	{
+		address = getWord(buf);
+		modified = getWord(buf);
+		data = getWord(buf);
+		if (address < 0 || address >= MEM_SIZE)
+			return 0;
+		if (addBlockToCache(cache, address, data, (char)modified, &evictAddr, &evictData) == 2)
+			comp->mem->data[evictAddr] = evictData;
+	}
+	cache->writes -= numValid; // Refilling is not an access
+	cache->retryAddress = (buf->position < buf->length) ? getWord(buf) : -1;
+
+	numShared = (buf->position < buf->length) ? getWord(buf) : 0;
+	for (i = 0; i < numShared && !buf->truncated; i++)
+	{
+		address = getWord(buf);
+		data = getWord(buf);
+		if (address < 0 || address >= MEM_SIZE || (block = findBlock(cache, address)) == NULL)
+			return 0;
+		block->shared = (char)data;
+	}
+	return 1;
+}
+
+// Histogram i of the bus, counting through latencies[NumBusLatencies][NUM_CORES][NumBusCommands]
+LatencyHistogram* getBusHistogram(MSIBus bus, int i)
+{
+	return &bus->latencies[0][0][0] + i;
+}
+
+void saveHistogram(const LatencyHistogram* histogram, CheckpointBuffer* buf)
+{
+	int i;
+
+	putWord(buf, histogram->count);
+	putWord(buf, histogram->max);
+	for (i = 0; i < HISTOGRAM_BUCKETS; i++)
+		putWord(buf, histogram->buckets[i]);
+}
+
+void restoreHistogram(LatencyHistogram* histogram, CheckpointBuffer* buf)
+{
+	int i;
+
+	histogram->count = getWord(buf);
+	histogram->max = getWord(buf);
+	for (i = 0; i < HISTOGRAM_BUCKETS; i++)
+		histogram->buckets[i] = getWord(buf);
+}
+
+bool isInitialMigratoryLine(const MigratoryLine* line)
+{
+	return line->lastWriter == -1 && !line->migratory && !line->confidence && !line->granted && !line->classified;
+}
+
+void saveBus(MSIBus bus, CheckpointBuffer* buf)
+{
+	int i, addr, numWatched = 0, numLines, numHistograms;
+	MigratoryLine* line;
+
+	putWord(buf, bus->busOrigid);
+	putWord(buf, bus->busCmd);
+	putWord(buf, bus->busAddr);
+	putWord(buf, bus->busData);
+	putWord(buf, bus->busBusy);
+	putWord(buf, bus->busWaitCycles);
+	putWord(buf, bus->busSupplier);
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		putWord(buf, bus->pendingCmd[i]);
+		putWord(buf, bus->pendingAddr[i]);
+	}
+	putWord(buf, bus->nextCore);
+	putWord(buf, bus->cycle);
+	for (i = 0; i < NumBusCommands; i++)
+		putWord(buf, bus->cmdCount[i]);
+
+	// LL reservations, only the watched or broken addresses
+	for (i = 0; i < NUM_CORES; i++)
+		for (addr = 0; addr < MEM_SIZE; addr++)
+			if (bus->coreWatchFlags[i][addr] != (char)NotWatched)
+				numWatched++;
+	putWord(buf, numWatched);
+	for (i = 0; i < NUM_CORES; i++)
+		for (addr = 0; addr < MEM_SIZE; addr++)
+			if (bus->coreWatchFlags[i][addr] != (char)NotWatched)
+			{
+				putWord(buf, i);
+				putWord(buf, addr);
+				putWord(buf, bus->coreWatchFlags[i][addr]);
+			}
+
+	// Migratory sharing state, only the lines that left their initial state
+	putWord(buf, bus->busExclusive);
+	putWord(buf, bus->migratoryLines);
+	putWord(buf, bus->migratoryGrants);
+	putWord(buf, bus->migratorySaved);
+	putWord(buf, bus->migratoryReverts);
+	numLines = 0;
+	for (addr = 0; bus->migratory != NULL && addr < MEM_SIZE; addr++)
+		if (!isInitialMigratoryLine(&bus->migratory[addr]))
+			numLines++;
+	putWord(buf, numLines);
+	for (addr = 0; bus->migratory != NULL && addr < MEM_SIZE; addr++)
+		if (!isInitialMigratoryLine(&bus->migratory[addr]))
+		{
+			line = &bus->migratory[addr];
+			putWord(buf, addr);
+			putWord(buf, line->lastWriter);
+			putWord(buf, line->migratory);
+			putWord(buf, line->confidence);
+			putWord(buf, line->granted);
+			putWord(buf, line->classified);
+		}
+
+	// Latency accounting, the cycles of the requests in flight and the histograms that have samples
+	for (i = 0; i < NUM_CORES; i++)
+		putWord(buf, bus->requestCycle[i]);
+	putWord(buf, bus->grantCycle);
+	numHistograms = 0;
+	for (i = 0; i < NUM_BUS_HISTOGRAMS; i++)
+		if (getBusHistogram(bus, i)->count > 0)
+			numHistograms++;
+	putWord(buf, numHistograms);
+	for (i = 0; i < NUM_BUS_HISTOGRAMS; i++)
+		if (getBusHistogram(bus, i)->count > 0)
+		{
+			putWord(buf, i);
+			saveHistogram(getBusHistogram(bus, i), buf);
+		}
+}
+
+void restoreBus(MSIBus bus, CheckpointBuffer* buf)
+{
+	int i, core, addr, numWatched, numLines, numHistograms;
+	MigratoryLine line;
+
+	bus->busOrigid = (BusOrigId)getWord(buf);
+	bus->busCmd = (BusCommand)getWord(buf);
+	bus->busAddr = getWord(buf);
+	bus->busData = getWord(buf);
+	bus->busBusy = (bool)getWord(buf);
+	bus->busWaitCycles = getWord(buf);
+	bus->busSupplier = (BusOrigId)getWord(buf);
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		bus->pendingCmd[i] = (BusCommand)getWord(buf);
+		bus->pendingAddr[i] = getWord(buf);
+	}
+	bus->nextCore = getWord(buf);
+	bus->cycle = getWord(buf);
+	for (i = 0; i < NUM_CORES; i++)
+		bus->requestCycle[i] = bus->cycle; // Without the latency state requests in flight start at the checkpoint
+	bus->grantCycle = bus->cycle;
+	for (i = 0; i < NumBusCommands; i++)
+		bus->cmdCount[i] = getWord(buf);
+
+	memset(bus->coreWatchFlags, NotWatched, sizeof(bus->coreWatchFlags));
+	numWatched = getWord(buf);
+	while (numWatched-- > 0 && !buf->truncated)
+	{
+		core = getWord(buf);
+		addr = getWord(buf);
+		if (core < 0 || core >= NUM_CORES || addr < 0 || addr >= MEM_SIZE)
+		{
+			buf->truncated = True;
+			return;
+		}
+		bus->coreWatchFlags[core][addr] = (char)getWord(buf);
+	}
+
+	if (buf->position >= buf->length)
+		return;
+	bus->busExclusive = (bool)getWord(buf);
+	bus->migratoryLines = getWord(buf);
+	bus->migratoryGrants = getWord(buf);
+	bus->migratorySaved = getWord(buf);
+	bus->migratoryReverts = getWord(buf);
+	for (addr = 0; bus->migratory != NULL && addr < MEM_SIZE; addr++)
+	{
+		memset(&bus->migratory[addr], 0, sizeof(MigratoryLine));
+		bus->migratory[addr].lastWriter = -1;
+	}
+	// Lines of a run with the optimization are dropped when restoring without it
+	numLines = getWord(buf);
+	while (numLines-- > 0 && !buf->truncated)
+	{
+		addr = getWord(buf);
+		line.lastWriter = (signed char)getWord(buf);
+		line.migratory = (char)getWord(buf);
+		line.confidence = (char)getWord(buf);
+		line.granted = (char)getWord(buf);
+		line.classified = (char)getWord(buf);
+		if (addr < 0 || addr >= MEM_SIZE)
+		{
+			buf->truncated = True;
+			return;
+		}
+		if (bus->migratory != NULL)
+			bus->migratory[addr] = line;
+	}
+
+	if (buf->position >= buf->length)
+		return;
+	for (i = 0; i < NUM_CORES; i++)
+		bus->requestCycle[i] = getWord(buf);
+	bus->grantCycle = getWord(buf);
+	memset(bus->latencies, 0, sizeof(bus->latencies));
+	numHistograms = getWord(buf);
+	while (numHistograms-- > 0 && !buf->truncated)
+	{
+		i = getWord(buf);
+		if (i < 0 || i >= NUM_BUS_HISTOGRAMS)
+		{
+			buf->truncated = True;
+			return;
+		}
+		restoreHistogram(getBusHistogram(bus, i), buf);
+	}
+}
+
+void saveStageInstruction(const StageInstruction* slot, CheckpointBuffer* buf)
+{
+	putWord(buf, slot->valid);
+	putWord(buf, slot->data);
+	putWord(buf, slot->addr);
+	putWord(buf, slot->pc);
+	putWord(buf, slot->predictedTaken);
+	putWord(buf, slot->memDone);
+	putWord(buf, slot->inst.type);
+	putWord(buf, slot->inst.op);
+	putWord(buf, slot->inst.rs);
+	putWord(buf, slot->inst.rt);
+	putWord(buf, slot->inst.rd);
+	putWord(buf, slot->inst.hasImm);
+	putWord(buf, slot->inst.imm);
+	putWord(buf, slot->inst.rsData);
+	putWord(buf, slot->inst.rtData);
+	putWord(buf, slot->inst.rdData);
+	putWord(buf, slot->inst.isHalt);
+}
+
+void restoreStageInstruction(StageInstruction* slot, CheckpointBuffer* buf)
+{
+	slot->valid = (bool)getWord(buf);
+	slot->data = getWord(buf);
+	slot->addr = getWord(buf);
+	slot->pc = getWord(buf);
+	slot->predictedTaken = (bool)getWord(buf);
+	slot->memDone = (bool)getWord(buf);
+	slot->inst.type = (instruction_type)getWord(buf);
+	slot->inst.op = (opcode)getWord(buf);
+	slot->inst.rs = getWord(buf);
+	slot->inst.rt = getWord(buf);
+	slot->inst.rd = getWord(buf);
+	slot->inst.hasImm = (bool)getWord(buf);
+	slot->inst.imm = getWord(buf);
+	slot->inst.rsData = getWord(buf);
+	slot->inst.rtData = getWord(buf);
+	slot->inst.rdData = getWord(buf);
+	slot->inst.isHalt = (bool)getWord(buf);
+}
+
+// Statistics of the pipeline in the order they are saved, returns how many
+int getPipelineCounters(Pipeline* pipe, int* counters[])
+{
+	int n = 0, i;
+
+	counters[n++] = &pipe->dataHazardStallCycles;
+	counters[n++] = &pipe->totalCycles;
+	counters[n++] = &pipe->ifUtil;
+	counters[n++] = &pipe->idUtil;
+	counters[n++] = &pipe->exUtil;
+	counters[n++] = &pipe->memUtil;
+	counters[n++] = &pipe->wbUtil;
+	counters[n++] = &pipe->dataStallCycles;
+	counters[n++] = &pipe->loadUseStallCycles;
+	counters[n++] = &pipe->stallCyclesAvoided;
+	for (i = 0; i < NumForwardPaths; i++)
+		counters[n++] = &pipe->forwards[i];
+	counters[n++] = &pipe->branches;
+	counters[n++] = &pipe->mispredictions;
+	counters[n++] = &pipe->flushCycles;
+	counters[n++] = &pipe->pairedIssues;
+	counters[n++] = &pipe->bufferedStores;
+	counters[n++] = &pipe->storeForwards;
+	counters[n++] = &pipe->storeBufferStalls;
+	counters[n++] = &pipe->storeCyclesHidden;
+	counters[n++] = &pipe->fastForwarded;
+	for (i = 0; i < NumCycleBuckets; i++)
+		counters[n++] = &pipe->cycleBuckets[i];
+	return n;
+}
+
+void savePipeline(Pipeline* pipe, CheckpointBuffer* buf)
+{
+	int* counters[MAX_PIPELINE_COUNTERS];
+	int i, numCounters;
+	StageStatus* stat;
+	StoreBufferEntry* entry;
+
+	putWord(buf, pipe->cache->id);
+	putWord(buf, pipe->issueWidth);
+	for (i = 0; i < NUM_REGS; i++)
+		putWord(buf, pipe->registers[i]);
+	putWord(buf, pipe->PC);
+	putWord(buf, pipe->fetchSlot);
+	putWord(buf, pipe->stalledDataHazard);
+	putWord(buf, pipe->flushBranchFlag);
+	putWord(buf, pipe->branchTaken);
+	putWord(buf, pipe->totally_done);
+	putWord(buf, pipe->storeBufferWait);
+
+	for (i = 0; i < NumStages; i++)
+	{
+		saveStageInstruction(&pipe->stageInst[i], buf);
+		saveStageInstruction(&pipe->pairInst[i], buf);
+
+		stat = &pipe->stageStat[i];
+		putWord(buf, stat->stalled);
+		putWord(buf, stat->stallNextCycle);
+		putWord(buf, stat->delayedWrite);
+		putWord(buf, stat->delayedWriteReg);
+		putWord(buf, stat->delayedWriteData);
+		putWord(buf, stat->pairDelayedWrite);
+		putWord(buf, stat->pairDelayedWriteReg);
+		putWord(buf, stat->pairDelayedWriteData);
+	}
+
+	numCounters = getPipelineCounters(pipe, counters);
+	putWord(buf, numCounters);
+	for (i = 0; i < numCounters; i++)
+		putWord(buf, *counters[i]);
+
+	// Predictor tables, -1 without a predictor
+	putWord(buf, (pipe->predictor != NULL) ? (int)pipe->predictor->scheme : -1);
+	if (pipe->predictor != NULL)
+	{
+		for (i = 0; i < BTB_ENTRIES; i++)
+		{
+			putWord(buf, pipe->predictor->btb[i].valid);
+			putWord(buf, pipe->predictor->btb[i].pc);
+			putWord(buf, pipe->predictor->btb[i].target);
+		}
+		for (i = 0; i < PHT_ENTRIES; i++)
+			putWord(buf, pipe->predictor->counters[i]);
+		putWord(buf, (int)pipe->predictor->history);
+	}
+
+	// Buffered stores oldest first, -1 without a store buffer
+	putWord(buf, (pipe->storeBuffer != NULL) ? pipe->storeBuffer->count : -1);
+	for (i = 0; pipe->storeBuffer != NULL && i < pipe->storeBuffer->count; i++)
+	{
+		entry = &pipe->storeBuffer->entries[(pipe->storeBuffer->head + i) % STORE_BUFFER_ENTRIES];
+		putWord(buf, entry->addr);
+		putWord(buf, entry->data);
+		putWord(buf, entry->cycle);
+	}
+
+	// Cycle accounting state follows, it was added after the rest
+	for (i = 0; i < NumStages; i++)
+	{
+		putWord(buf, pipe->stageInst[i].bubbleCause);
+		putWord(buf, pipe->pairInst[i].bubbleCause);
+	}
+	putWord(buf, pipe->scRetry);
+	putWord(buf, pipe->faulted);
+}
+
+int restorePipeline(Computer comp, CheckpointBuffer* buf)
+{
+	int* counters[MAX_PIPELINE_COUNTERS];
+	int id = getWord(buf);
+	int i, numCounters, numSaved, scheme, numStores, addr, data, cycle;
+	Pipeline* pipe;
+	StageStatus* stat;
+	BranchPredictor bp;
+
+	if (id < 0 || id >= NUM_CORES)
+		return 0;
+	pipe = comp->pipes[id];
+
+	if (getWord(buf) != pipe->issueWidth)
+	{
+		fprintf(stderr, "Checkpoint of core %d has another issue width.\n", id);
+		return 0;
+	}
+	for (i = 0; i < NUM_REGS; i++)
+		pipe->registers[i] = getWord(buf);
+	pipe->PC = getWord(buf);
+	pipe->fetchSlot = getWord(buf);
+	pipe->stalledDataHazard = (bool)getWord(buf);
+	pipe->flushBranchFlag = (bool)getWord(buf);
+	pipe->branchTaken = (bool)getWord(buf);
+	pipe->totally_done = (bool)getWord(buf);
+	pipe->storeBufferWait = (bool)getWord(buf);
+
+	for (i = 0; i < NumStages; i++)
+	{
+		restoreStageInstruction(&pipe->stageInst[i], buf);
+		restoreStageInstruction(&pipe->pairInst[i], buf);
+
+		stat = &pipe->stageStat[i];
+		stat->stalled = (bool)getWord(buf);
+		stat->stallNextCycle = (bool)getWord(buf);
+		stat->delayedWrite = (bool)getWord(buf);
+		stat->delayedWriteReg = getWord(buf);
+		stat->delayedWriteData = getWord(buf);
+		stat->pairDelayedWrite = (bool)getWord(buf);
+		stat->pairDelayedWriteReg = getWord(buf);
+		stat->pairDelayedWriteData = getWord(buf);
+	}
+
+	// Counters a later version added are skipped, ones it lacks stay zero
+	numCounters = getPipelineCounters(pipe, counters);
+	numSaved = getWord(buf);
+	for (i = 0; i < numSaved && !buf->truncated; i++)
+	{
+		data = getWord(buf);
+		if (i < numCounters)
+			*counters[i] = data;
+	}
+
+	// Predictor state is kept only for the same scheme, another one starts cold
+	scheme = getWord(buf);
+	bp = (pipe->predictor != NULL && (int)pipe->predictor->scheme == scheme) ? pipe->predictor : NULL;
+	if (scheme >= 0)
+	{
+		for (i = 0; i < BTB_ENTRIES; i++)
+		{
+			BTBEntry entry;
+
+			entry.valid = (bool)getWord(buf);
+			entry.pc = getWord(buf);
+			entry.target = getWord(buf);
+			if (bp != NULL)
+				bp->btb[i] = entry;
+		}
+		for (i = 0; i < PHT_ENTRIES; i++)
+		{
+			data = getWord(buf);
+			if (bp != NULL)
+				bp->counters[i] = (unsigned char)data;
+		}
+		data = getWord(buf);
+		if (bp != NULL)
+			bp->history = (unsigned int)data;
+	}
+
+	numStores = getWord(buf);
+	if (numStores > 0 && pipe->storeBuffer == NULL)
+	{
+		fprintf(stderr, "Checkpoint of core %d has buffered stores, the computer has no store buffer.\n", id);
+		return 0;
+	}
+	if (pipe->storeBuffer != NULL)
+	{
+		pipe->storeBuffer->head = 0;
+		pipe->storeBuffer->count = 0;
+	}
+	for (i = 0; i < numStores && !buf->truncated; i++)
+	{
+		addr = getWord(buf);
+		data = getWord(buf);
+		cycle = getWord(buf);
+		if (!isStoreBufferFull(pipe->storeBuffer))
+			pushStore(pipe->storeBuffer, addr, data, cycle);
+	}
+
+	if (buf->position < buf->length)
+	{
+		for (i = 0; i < 2 * NumStages; i++)
+		{
+			data = getWord(buf);
+			if (data < 0 || data >= CycleHalted)
+				data = CycleFrontEnd;
+			getSlot(pipe, (Stage)(i / 2), i % 2)->bubbleCause = (CycleBucket)data;
+		}
+		pipe->scRetry = (bool)getWord(buf);
+	}
+	pipe->faulted = (buf->position < buf->length) ? (bool)getWord(buf) : False;
+	return 1;
+}
+
+// A baseline or frozen copy of a registered histogram, NULL when the registry has none yet
+void saveHistogramCopy(const LatencyHistogram* histogram, CheckpointBuffer* buf)
+{
+	putWord(buf, histogram != NULL);
+	if (histogram != NULL)
+		saveHistogram(histogram, buf);
+}
+
+int restoreHistogramCopy(LatencyHistogram** histogram, CheckpointBuffer* buf)
+{
+	if (!getWord(buf))
+		return 1;
+	if (*histogram == NULL && (*histogram = (LatencyHistogram*)malloc(sizeof(LatencyHistogram))) == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for statistics.\n");
+		return 0;
+	}
+	restoreHistogram(*histogram, buf);
+	return 1;
+}
+
+void saveStats(Computer comp, CheckpointBuffer* buf)
+{
+	StatCounter* counter;
+	int i;
+
+	putWord(buf, comp->roi);
+	putWord(buf, comp->roiCores);
+	putWord(buf, comp->stats->numCounters);
+	for (i = 0; i < comp->stats->numCounters; i++)
+	{
+		counter = &comp->stats->counters[i];
+		putWord(buf, counter->baseline);
+		putWord(buf, counter->frozen);
+		putWord(buf, counter->frozenValue);
+		saveHistogramCopy(counter->histogramBaseline, buf);
+		saveHistogramCopy(counter->histogramFrozen, buf);
+	}
+}
+
+int restoreStats(Computer comp, CheckpointBuffer* buf)
+{
+	StatCounter* counter;
+	int i;
+
+	comp->roi = (RoiState)getWord(buf);
+	comp->roiCores = getWord(buf);
+	// The counters are registered in the same order by computers of any configuration
+	if (getWord(buf) != comp->stats->numCounters)
+	{
+		fprintf(stderr, "Checkpoint has other statistics counters.\n");
+		return 0;
+	}
+	for (i = 0; i < comp->stats->numCounters && !buf->truncated; i++)
+	{
+		counter = &comp->stats->counters[i];
+		counter->baseline = getWord(buf);
+		counter->frozen = (bool)getWord(buf);
+		counter->frozenValue = getWord(buf);
+		if (!restoreHistogramCopy(&counter->histogramBaseline, buf) ||
+			!restoreHistogramCopy(&counter->histogramFrozen, buf))
+			return 0;
+	}
+	return 1;
+}
+
+int saveCheckpoint(Computer comp, FILE* out)
+{
+	CheckpointBuffer buf = { NULL, 0, 0, 0, False };
+	int i, status;
+
+	putWord(&buf, CHECKPOINT_MAGIC);
+	putWord(&buf, CHECKPOINT_VERSION);
+	status = !buf.truncated && fwrite(buf.data, 1, buf.length, out) == buf.length;
+	buf.length = 0;
+
+	putWord(&buf, NUM_CORES);
+	putWord(&buf, comp->totalCycles);
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		putWord(&buf, comp->progs[i]->numInstructions);
+		putWord(&buf, (int)programChecksum(comp->progs[i]->instructions, comp->progs[i]->numInstructions));
+	}
+	status = status && writeSection(out, CheckpointComputer, &buf);
+
+	saveMemory(comp->mem, &buf);
+	status = status && writeSection(out, CheckpointMemory, &buf);
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		saveCache(comp->caches[i], &buf);
+		status = status && writeSection(out, CheckpointCache, &buf);
+	}
+	saveBus(comp->bus, &buf);
+	status = status && writeSection(out, CheckpointBus, &buf);
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		savePipeline(comp->pipes[i], &buf);
+		status = status && writeSection(out, CheckpointPipeline, &buf);
+	}
+	saveStats(comp, &buf);
+	status = status && writeSection(out, CheckpointStats, &buf);
+	status = status && writeSection(out, CheckpointEnd, &buf);
+
+	free(buf.data);
+	if (!status)
+		fprintf(stderr, "Could not write checkpoint.\n");
+	return status;
+}
+
+// Check the checkpoint was taken running the programs of the computer
+int restoreComputer(Computer comp, CheckpointBuffer* buf)
+{
+	int i, numInstructions, checksum;
+
+	if (getWord(buf) != NUM_CORES)
+	{
+		fprintf(stderr, "Checkpoint has another number of cores.\n");
+		return 0;
+	}
+	comp->totalCycles = getWord(buf);
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		numInstructions = getWord(buf);
+		checksum = getWord(buf);
+		if (numInstructions != comp->progs[i]->numInstructions ||
+			checksum != (int)programChecksum(comp->progs[i]->instructions, comp->progs[i]->numInstructions))
+		{
+			fprintf(stderr, "Checkpoint was taken with another program on core %d.\n", i);
+			return 0;
+		}
+	}
+	return 1;
+}
+
+int restoreCheckpoint(Computer comp, FILE* in)
+{
+	unsigned char bytes[8];
+	CheckpointBuffer header = { bytes, 8, 8, 0, False };
+	CheckpointBuffer buf = { NULL, 0, 0, 0, False };
+	CheckpointSection tag = CheckpointComputer;
+	int status = 1;
+
+	if (fread(bytes, 1, 8, in) != 8 || getWord(&header) != CHECKPOINT_MAGIC)
+	{
+		fprintf(stderr, "Not a checkpoint.\n");
+		return 0;
+	}
+	if (getWord(&header) > CHECKPOINT_VERSION)
+	{
+		fprintf(stderr, "Checkpoint version is newer than this simulator.\n");
+		return 0;
+	}
+
+	// Memory is restored before the caches, which write back the blocks they cannot hold
+	while (status && tag != CheckpointEnd)
+	{
+		if (!readSection(in, &tag, &buf))
+		{
+			fprintf(stderr, "Checkpoint is truncated.\n");
+			status = 0;
+			break;
+		}
+		switch (tag)
+		{
+		case CheckpointComputer: status = restoreComputer(comp, &buf); break;
+		case CheckpointMemory:   restoreMemory(comp->mem, &buf); break;
+		case CheckpointCache:    status = restoreCache(comp, &buf); break;
+		case CheckpointBus:      restoreBus(comp->bus, &buf); break;
+		case CheckpointPipeline: status = restorePipeline(comp, &buf); break;
+		case CheckpointStats:    status = restoreStats(comp, &buf); break;
+		default:                 break; // Section of a later version
+		}
+		if (buf.truncated)
+		{
+			fprintf(stderr, "Checkpoint section %d is corrupt.\n", tag);
+			status = 0;
+		}
+	}
+
+	free(buf.data);
+	return status;
+}
+
+int saveCheckpointFile(Computer comp, char* fileName)
+{
+	FILE* out = fopen(fileName, "wb");
+	int status;
+
+	if (out == NULL)
+	{
+		fprintf(stderr, "Could not open checkpoint %s.\n", fileName);
+		return 0;
+	}
+	status = saveCheckpoint(comp, out);
+	if (fclose(out) != 0)
+		status = 0;
+	return status;
+}
+
+int restoreCheckpointFile(Computer comp, char* fileName)
+{
+	FILE* in = fopen(fileName, "rb");
+	int status;
+
+	if (in == NULL)
+	{
+		fprintf(stderr, "Could not open checkpoint %s.\n", fileName);
+		return 0;
+	}
+	status = restoreCheckpoint(comp, in);
+	fclose(in);
+	return status;
+}
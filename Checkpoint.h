@@ -0,0 +1,98 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include "Shared.h"
+#include "MultiCoreComputer.h"
+
+/* Checkpoint of a whole computer
+ *
+ * A checkpoint is a header followed by tagged sections, each with its
+ * length, written and read strictly in order so a checkpoint may go through
+ * a pipe. Words are 32 bit little endian whatever the host. A reader skips
+ * sections with tags it does not know, so later versions may add sections.
+ *
+ *  ------------------------------------------------------------------------------
+ * | Header | Computer | Memory | Cache 0..3 | Bus | Pipeline 0..3 | Stats | End |
+ *  ------------------------------------------------------------------------------
+ *
+ * Memory holds only the pages with a non-zero word. Caches hold their valid
+ * blocks in LRU order and are refilled through addBlockToCache, so the
+ * computer restored into may have another cache geometry: blocks that no
+ * longer fit are evicted, modified ones written back to memory. Memory
+ * latency, forwarding and branch prediction may also differ. The programs,
+ * issue width and, while stores are buffered, memory model must match.
+ */
+
+#define CHECKPOINT_MAGIC   0x504B434D   /* "MCKP" */
+#define CHECKPOINT_VERSION 1
+#define CHECKPOINT_PAGE_WORDS 1024
+#define MAX_PIPELINE_COUNTERS 64
+#define NUM_BUS_HISTOGRAMS (NumBusLatencies * NUM_CORES * NumBusCommands)
+
+typedef enum
+{
+	CheckpointEnd = 0,
+	CheckpointComputer,
+	CheckpointMemory,
+	CheckpointCache,
+	CheckpointBus,
+	CheckpointPipeline,
+	CheckpointStats
+} CheckpointSection;
+
+/* Growable byte buffer holding one section */
+typedef struct
+{
+	unsigned char* data;
+	size_t length;
+	size_t capacity;
+	size_t position;        /* Read position */
+	bool truncated;         /* A read went past the end of the section */
+} CheckpointBuffer;
+
+/* Valid cache block and its set, ordered by last use when saved */
+typedef struct
+{
+	Block block;
+	int set;
+} CheckpointBlock;
+
+/* Write the state of the computer, returns 1 on success */
+int saveCheckpoint(Computer comp, FILE* out);
+int saveCheckpointFile(Computer comp, char* fileName);
+
+/* Restore a checkpoint into a computer initialized with the same programs,
+   possibly with another configuration. Returns 1 on success. */
+int restoreCheckpoint(Computer comp, FILE* in);
+int restoreCheckpointFile(Computer comp, char* fileName);
+
+void putWord(CheckpointBuffer* buf, int word);
+int getWord(CheckpointBuffer* buf);
+int writeSection(FILE* out, CheckpointSection tag, CheckpointBuffer* buf);
+// Read the next section into buf, returns 0 on a read error
+int readSection(FILE* in, CheckpointSection* tag, CheckpointBuffer* buf);
+
+void saveMemory(Memory mem, CheckpointBuffer* buf);
+void saveStageInstruction(const StageInstruction* slot, CheckpointBuffer* buf);
+void restoreStageInstruction(StageInstruction* slot, CheckpointBuffer* buf);
+int getPipelineCounters(Pipeline* pipe, int* counters[]);
+int compareBlockUse(const void* a, const void* b);
+int restoreComputer(Computer comp, CheckpointBuffer* buf);
+void saveCache(Cache cache, CheckpointBuffer* buf);
+LatencyHistogram* getBusHistogram(MSIBus bus, int i);
+void saveHistogram(const LatencyHistogram* histogram, CheckpointBuffer* buf);
+void restoreHistogram(LatencyHistogram* histogram, CheckpointBuffer* buf);
+bool isInitialMigratoryLine(const MigratoryLine* line);
+void saveBus(MSIBus bus, CheckpointBuffer* buf);
+void savePipeline(Pipeline* pipe, CheckpointBuffer* buf);
+void restoreMemory(Memory mem, CheckpointBuffer* buf);
+int restoreCache(Computer comp, CheckpointBuffer* buf);
+void restoreBus(MSIBus bus, CheckpointBuffer* buf);
+int restorePipeline(Computer comp, CheckpointBuffer* buf);
+void saveHistogramCopy(const LatencyHistogram* histogram, CheckpointBuffer* buf);
+int restoreHistogramCopy(LatencyHistogram** histogram, CheckpointBuffer* buf);
+// Region of interest and the registry's reset baselines and frozen values
+void saveStats(Computer comp, CheckpointBuffer* buf);
+int restoreStats(Computer comp, CheckpointBuffer* buf);
+
+#endif
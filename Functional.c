@@ -0,0 +1,263 @@
+#include "Functional.h"
+
+// The store has already written memory, so only a load takes the data of another owner
+void warmCaches(Computer comp, int core, int address, bool write)
+{
+	int i, evictAddr, evictData;
+	Block block = findBlock(comp->caches[core], address);
+
+	// A load of a valid block or a store to an owned one leaves the other caches as they are
+	if (block != NULL && block->invalid == 0 && (!write || block->modified == 1))
+	{
+		block->lastUsed = ++comp->caches[core]->useCounter;
+		block->data = comp->mem->data[address];
+		return;
+	}
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		if (i == core)
+			continue;
+
+		block = findBlock(comp->caches[i], address);
+		if (block == NULL || block->invalid == 1)
+			continue;
+		if (block->modified == 1 && !write) // The owner writes back
+			comp->mem->data[address] = block->data;
+		block->modified = 0;
+		block->shared = write ? 0 : 1;
+		block->invalid = write ? 1 : 0;
+	}
+
+	if (addBlockToCache(comp->caches[core], address, comp->mem->data[address], write, &evictAddr, &evictData) == 2)
+		comp->mem->data[evictAddr] = evictData;
+}
+
+// A block ends after a branch, JAL or halt, or before the fast-forward marker
+bool endsBlock(BlockCache bc, int pc)
+{
+	opcode op = bc->instructions[pc].op;
+
+	return isBranch(op) || isJal(op) || isHalt(op) || pc + 1 == bc->stopPc || pc + 1 >= bc->numInstructions;
+}
+
+BlockCache createBlockCache(Program prog, int* registers, int stopPc)
+{
+	BlockCache bc = (BlockCache)malloc(sizeof(struct BlockCache_));
+
+	if (bc == NULL || (bc->blocks = (BasicBlock**)calloc(prog->numInstructions, sizeof(BasicBlock*))) == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for block cache.\n");
+		free(bc);
+		return NULL;
+	}
+
+	bc->instructions = prog->instructions;
+	bc->numInstructions = prog->numInstructions;
+	bc->registers = registers;
+	bc->scratch = 0;
+	bc->stopPc = stopPc;
+	return bc;
+}
+
+void destroyBlockCache(BlockCache bc)
+{
+	int i;
+
+	if (bc == NULL)
+		return;
+
+	for (i = 0; i < bc->numInstructions; i++)
+		free(bc->blocks[i]);
+	free(bc->blocks);
+	free(bc);
+}
+
+BasicBlock* decodeBlock(BlockCache bc, int start)
+{
+	BasicBlock* block;
+	MicroOp* uop;
+	const Instruction* inst;
+	int* regs = bc->registers;
+	int length = 1, i;
+
+	while (!endsBlock(bc, start + length - 1))
+		length++;
+
+	// The micro-ops follow the block header in one allocation
+	block = (BasicBlock*)malloc(sizeof(BasicBlock) + length * sizeof(MicroOp));
+	if (block == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for basic block.\n");
+		return NULL;
+	}
+	block->start = start;
+	block->length = length;
+	block->ops = (MicroOp*)(block + 1);
+
+	for (i = 0; i < length; i++)
+	{
+		inst = &bc->instructions[start + i];
+		uop = &block->ops[i];
+		uop->op = inst->op;
+		uop->imm = inst->imm;
+		uop->rs = (inst->rs >= 0) ? &regs[inst->rs] : &bc->scratch;
+		uop->rt = (inst->hasImm && !isBranch(inst->op)) ? &uop->imm : (inst->rt >= 0) ? &regs[inst->rt] : &bc->scratch;
+		uop->data = (inst->rd >= 0) ? &regs[inst->rd] : &bc->scratch;
+		uop->rd = (inst->rd > 1 && inst->op != SW && !isBranch(inst->op)) ? &regs[inst->rd] : &bc->scratch;
+	}
+
+	bc->blocks[start] = block;
+	return block;
+}
+
+int runBlock(Computer comp, int core, BlockCache bc, int budget, bool warm, bool* stopped)
+{
+	Pipeline* pipe = comp->pipes[core];
+	int* mem = comp->mem->data;
+	BasicBlock* block = bc->blocks[pipe->PC];
+	const MicroOp* uop;
+	const MicroOp* end;
+	int addr, old;
+
+	if (block == NULL && (block = decodeBlock(bc, pipe->PC)) == NULL)
+	{
+		*stopped = True;
+		return 0;
+	}
+
+	end = block->ops + ((budget > 0 && budget < block->length) ? budget : block->length);
+	for (uop = block->ops; uop < end; uop++)
+	{
+		switch (uop->op)
+		{
+		case ADD: *uop->rd = *uop->rs + *uop->rt; break;
+		case SUB: *uop->rd = *uop->rs - *uop->rt; break;
+		case AND: *uop->rd = *uop->rs & *uop->rt; break;
+		case OR:  *uop->rd = *uop->rs | *uop->rt; break;
+		case XOR: *uop->rd = *uop->rs ^ *uop->rt; break;
+		case MUL: *uop->rd = *uop->rs * *uop->rt; break;
+		case SLL: *uop->rd = (int)((unsigned int)*uop->rs << (*uop->rt & 31)); break;
+		case SRA: *uop->rd = *uop->rs >> (*uop->rt & 31); break;
+		case SRL: *uop->rd = (int)((unsigned int)*uop->rs >> (*uop->rt & 31)); break;
+		case BEQ: case BNE: case BLT: case BGT: case BLE: case BGE: // The target is in imm
+			pipe->PC = isBranchTaken(uop->op, *uop->rs, *uop->rt) ? uop->imm : block->start + block->length;
+			return block->length;
+		case JAL:
+			bc->registers[15] = block->start + block->length;
+			pipe->PC = uop->imm;
+			return block->length;
+		case LW: case LL: case SW: case SC:
+			// Only memory operations interact with the other cores
+			addr = *uop->rs + *uop->rt;
+			if (addr < 0 || addr >= MEM_SIZE)
+			{
+				fprintf(stderr, "Address %d out of range at %d on core %d.\n", addr, block->start + (int)(uop - block->ops), core);
+				end = uop;
+				*stopped = True;
+				break;
+			}
+			if (uop->op == LL)
+				setCoreWatchFlag(comp->bus, (BusOrigId)core, addr);
+			if (isLoad(uop->op))
+			{
+				if (warm)
+					warmCaches(comp, core, addr, False);
+				*uop->rd = mem[addr];
+			}
+			else if (uop->op == SW || getCoreWatchResult(comp->bus, (BusOrigId)core, addr))
+			{
+				mem[addr] = *uop->data;
+				if (warm)
+					warmCaches(comp, core, addr, True);
+				*uop->rd = 1;
+			}
+			else // Failed SC
+				*uop->rd = 0;
+			break;
+		case FADD: case CAS: case SWAP:
+			addr = (uop->op == CAS) ? *uop->rs : *uop->rs + *uop->rt;
+			if (addr < 0 || addr >= MEM_SIZE)
+			{
+				fprintf(stderr, "Address %d out of range at %d on core %d.\n", addr, block->start + (int)(uop - block->ops), core);
+				end = uop;
+				*stopped = True;
+				break;
+			}
+			old = mem[addr];
+			if (uop->op == FADD)
+				mem[addr] = old + *uop->data;
+			else if (uop->op == SWAP || old == *uop->rt)
+				mem[addr] = *uop->data;
+			breakCoreWatches(comp->bus, (BusOrigId)core, addr);
+			if (warm)
+				warmCaches(comp, core, addr, True);
+			*uop->rd = old;
+			break;
+		case FENCE:
+		case ROI_BEGIN: case ROI_END: case STATS_RESET: case STATS_DUMP: // Statistics start with the detailed run
+			break;
+		case HALT: // Left in place, the pipeline never runs
+			pipe->totally_done = True;
+			end = uop;
+			*stopped = True;
+			break;
+		default:
+			fprintf(stderr, "Unrecognized instruction %d at %d on core %d.\n", uop->op, block->start + (int)(uop - block->ops), core);
+			end = uop;
+			*stopped = True;
+			break;
+		}
+	}
+
+	pipe->PC = block->start + (int)(end - block->ops);
+	return (int)(end - block->ops);
+}
+
+int fastForwardComputer(Computer comp, int maxInstructions, int markerPc, bool warm)
+{
+	int i, executed, total = 0;
+	BlockCache blockCaches[NUM_CORES];
+	bool running[NUM_CORES], anyRunning = True, stopped;
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		running[i] = !comp->pipes[i]->totally_done;
+		blockCaches[i] = createBlockCache(comp->progs[i], comp->pipes[i]->registers, markerPc);
+		if (blockCaches[i] == NULL)
+			running[i] = False;
+	}
+
+	// One basic block of each core in turn
+	while (anyRunning)
+	{
+		anyRunning = False;
+		for (i = 0; i < NUM_CORES; i++)
+		{
+			if (!running[i])
+				continue;
+			if ((maxInstructions > 0 && comp->pipes[i]->fastForwarded >= maxInstructions) || comp->pipes[i]->PC == markerPc)
+			{
+				running[i] = False;
+				continue;
+			}
+			stopped = False;
+			executed = runBlock(comp, i, blockCaches[i], maxInstructions - comp->pipes[i]->fastForwarded, warm, &stopped);
+			running[i] = !stopped;
+			comp->pipes[i]->fastForwarded += executed;
+			total += executed;
+			anyRunning = True;
+		}
+	}
+
+	// The detailed run counts its own accesses
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		destroyBlockCache(blockCaches[i]);
+		comp->caches[i]->hits = 0;
+		comp->caches[i]->misses = 0;
+		comp->caches[i]->reads = 0;
+		comp->caches[i]->writes = 0;
+	}
+	return total;
+}
@@ -0,0 +1,67 @@
+#ifndef FUNCTIONAL_H
+#define FUNCTIONAL_H
+
+/* Functional execution of the programs, without timing.
+ *
+ * The cores run the same instructions as the pipelines with architectural
+ * semantics only, one basic block per core in turn, on the registers and PC
+ * of the pipelines and on main memory. When fast-forwarding stops, the
+ * pipelines start from that state, so a detailed run measures only the
+ * region after it.
+ *
+ * Each core decodes a basic block the first time it enters it, into
+ * micro-ops whose operands point straight at its registers, and keeps it
+ * for later entries. A block ends after a branch, JAL or halt.
+ */
+
+#include "Shared.h"
+#include "MultiCoreComputer.h"
+
+/* Decoded instruction, the operands point at registers of the core */
+typedef struct
+{
+	opcode op;
+	int* rd;                /* Written result, a scratch word for r0, r1 and instructions without one */
+	const int* rs;
+	const int* rt;          /* Points at imm for an immediate operand */
+	const int* data;        /* Stored register of SW and SC */
+	int imm;                /* Immediate, or the target of a branch or JAL */
+} MicroOp;
+
+typedef struct
+{
+	int start;              /* Address of the first instruction */
+	int length;
+	MicroOp* ops;
+} BasicBlock;
+
+struct BlockCache_
+{
+	const Instruction* instructions;
+	int numInstructions;
+	BasicBlock** blocks;    /* By start address, NULL until first entered */
+	int* registers;
+	int scratch;
+	int stopPc;             /* Blocks end before the fast-forward marker */
+};
+typedef struct BlockCache_* BlockCache;
+
+bool endsBlock(BlockCache bc, int pc);
+BlockCache createBlockCache(Program prog, int* registers, int stopPc);
+void destroyBlockCache(BlockCache bc);
+BasicBlock* decodeBlock(BlockCache bc, int start);
+// Execute up to budget instructions (0 = no limit) of the block at the PC of
+// core and return how many ran. *stopped is set when the core halted or hit
+// an address out of memory, which is left for the pipeline.
+int runBlock(Computer comp, int core, BlockCache bc, int budget, bool warm, bool* stopped);
+
+// Fill the cache of core with address as a load or store would, with no
+// bus cycles: other copies are downgraded or invalidated.
+void warmCaches(Computer comp, int core, int address, bool write);
+
+// Run every core functionally until it executed maxInstructions (0 = no limit),
+// reached markerPc (-1 = none) or halted. With warm set the caches hold the
+// blocks and MSI states the accesses left. Returns the instructions executed.
+int fastForwardComputer(Computer comp, int maxInstructions, int markerPc, bool warm);
+
+#endif
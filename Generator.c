@@ -0,0 +1,233 @@
+#include <string.h>
+#include "Generator.h"
+#include "Memory.h"
+
+#define MAX_SPEC_LINE 256
+#define MAX_GEN_PATH 512
+#define GEN_MAX_IMM 2047        /* Largest immediate of an instruction */
+
+/* Compute instructions, each keeps the accumulator $r11 depending on the loaded data */
+static const char* computeOps[] =
+{
+	"xor $r11, $r11, $r10",
+	"sll $r11, $r11, 1",
+	"xor $r11, $r11, $r2",
+	"srl $r11, $r11, 3",
+	"or $r13, $r11, $r10",
+	"and $r11, $r11, $r13"
+};
+#define NUM_COMPUTE_OPS (sizeof(computeOps) / sizeof(computeOps[0]))
+
+void getDefaultWorkloadSpec(WorkloadSpec* spec)
+{
+	spec->workingSet = 1024;
+	spec->accesses = 4096;
+	spec->readPercent = 70;
+	spec->sharedPercent = 20;
+	spec->sharers = NUM_CORES;
+	spec->stride = 1;
+	spec->lockPercent = 0;
+	spec->compute = 2;
+	spec->seed = 1;
+}
+
+int readWorkloadSpec(char* fileName, WorkloadSpec* spec)
+{
+	char line[MAX_SPEC_LINE];
+	char name[MAX_SPEC_LINE];
+	int value;
+	FILE* specFile = fopen(fileName, "r");
+
+	if (specFile == NULL)
+	{
+		fprintf(stderr, "Could not open workload specification %s.\n", fileName);
+		return 0;
+	}
+
+	getDefaultWorkloadSpec(spec);
+	while (fgets(line, MAX_SPEC_LINE, specFile))
+	{
+		if (strchr(line, '#') != NULL)
+			*strchr(line, '#') = '\0';
+		if (sscanf(line, "%s", name) != 1)
+			continue;
+		if (sscanf(line, "%*s %d", &value) != 1)
+		{
+			fprintf(stderr, "Workload parameter %s has no value.\n", name);
+			fclose(specFile);
+			return 0;
+		}
+
+		if (strcmp(name, "working_set") == 0)
+			spec->workingSet = value;
+		else if (strcmp(name, "accesses") == 0)
+			spec->accesses = value;
+		else if (strcmp(name, "read_percent") == 0)
+			spec->readPercent = value;
+		else if (strcmp(name, "shared_percent") == 0)
+			spec->sharedPercent = value;
+		else if (strcmp(name, "sharers") == 0)
+			spec->sharers = value;
+		else if (strcmp(name, "stride") == 0)
+			spec->stride = value;
+		else if (strcmp(name, "lock_percent") == 0)
+			spec->lockPercent = value;
+		else if (strcmp(name, "compute") == 0)
+			spec->compute = value;
+		else if (strcmp(name, "seed") == 0)
+			spec->seed = (unsigned int)value;
+		else
+		{
+			fprintf(stderr, "Unknown workload parameter %s.\n", name);
+			fclose(specFile);
+			return 0;
+		}
+	}
+
+	fclose(specFile);
+	return validateWorkloadSpec(spec);
+}
+
+int validateWorkloadSpec(const WorkloadSpec* spec)
+{
+	if (spec->workingSet < 1 || GEN_SHARED_BASE + (NUM_CORES + 1) * (long)spec->workingSet > MEM_SIZE)
+		fprintf(stderr, "Working set must be 1 - %d words.\n", (MEM_SIZE - GEN_SHARED_BASE) / (NUM_CORES + 1));
+	else if (spec->accesses < 1)
+		fprintf(stderr, "A core must make at least one access.\n");
+	else if (spec->readPercent < 0 || spec->readPercent > 100 || spec->sharedPercent < 0 || spec->sharedPercent > 100 ||
+		spec->lockPercent < 0 || spec->lockPercent > 100)
+		fprintf(stderr, "Percentages must be 0 - 100.\n");
+	else if (spec->sharers < 1 || spec->sharers > NUM_CORES)
+		fprintf(stderr, "Sharers must be 1 - %d.\n", NUM_CORES);
+	else if (spec->stride < 1 || spec->stride > spec->workingSet || spec->stride > GEN_MAX_IMM)
+		fprintf(stderr, "Stride must be 1 - the working set, and at most %d.\n", GEN_MAX_IMM);
+	else if (spec->compute < 0)
+		fprintf(stderr, "Compute instructions must not be negative.\n");
+	else
+		return 1;
+	return 0;
+}
+
+// xorshift32, the same sequence on every host
+unsigned int nextRandom(unsigned int* state)
+{
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+// True with the given percent probability
+bool drawPercent(unsigned int* state, int percent)
+{
+	return (int)(nextRandom(state) % 100) < percent;
+}
+
+// Load a constant of up to 20 bits into a register 11 bits at a time
+void emitConstant(FILE* out, int reg, int value)
+{
+	if (value <= GEN_MAX_IMM)
+	{
+		fprintf(out, "        add $r%d, $r0, %d\n", reg, value);
+		return;
+	}
+	emitConstant(out, reg, value >> 11);
+	fprintf(out, "        sll $r%d, $r%d, 11\n", reg, reg);
+	if (value & GEN_MAX_IMM)
+		fprintf(out, "        add $r%d, $r%d, %d\n", reg, reg, value & GEN_MAX_IMM);
+}
+
+// Access the word at base + offset, then advance the offset by the stride modulo the working set
+void emitAccess(FILE* out, bool load, int base, int offset, int* label)
+{
+	fprintf(out, "        add $r9, $r%d, $r%d\n", base, offset);
+	if (load)
+		fprintf(out, "        lw $r10, $r9, 0\n");
+	else
+		fprintf(out, "        sw $r11, $r9, 0\n");
+	fprintf(out, "        add $r%d, $r%d, $r8\n", offset, offset);
+	fprintf(out, "        blt $r1, $r%d, $r7, G%d\n", offset, *label);
+	fprintf(out, "        sub $r%d, $r%d, $r7\n", offset, offset);
+	fprintf(out, "G%d:\n", (*label)++);
+}
+
+// Increment the next shared word holding the lock
+void emitLockedAccess(FILE* out, int* label)
+{
+	int acquire = (*label)++;
+
+	fprintf(out, "G%d:     ll $r12, $r0, %d\n", acquire, GEN_LOCK_ADDR);
+	fprintf(out, "        bne $r1, $r12, $r0, G%d\n", acquire);
+	fprintf(out, "        add $r12, $r0, 1\n");
+	fprintf(out, "        sc $r12, $r0, %d\n", GEN_LOCK_ADDR);
+	fprintf(out, "        beq $r1, $r12, $r0, G%d\n", acquire);
+	emitAccess(out, True, 4, 6, label);
+	fprintf(out, "        add $r10, $r10, 1\n");
+	fprintf(out, "        sw $r10, $r9, 0\n");
+	fprintf(out, "        sw $r0, $r0, %d     ; release\n", GEN_LOCK_ADDR);
+}
+
+void generateProgram(FILE* out, const WorkloadSpec* spec, int core)
+{
+	unsigned int state = spec->seed * 2654435761u ^ (unsigned int)(core + 1) * 40503u;
+	int bodyAccesses = (spec->accesses < GEN_BODY_ACCESSES) ? spec->accesses : GEN_BODY_ACCESSES;
+	int label = 0;
+	int i, j;
+	bool shared;
+
+	if (state == 0)
+		state = 1;
+
+	fprintf(out, "; Synthetic workload of core %d: working set %d, %d accesses, %d%% reads, %d%% shared by %d cores,\n",
+		core, spec->workingSet, bodyAccesses * (spec->accesses / bodyAccesses), spec->readPercent,
+		spec->sharedPercent, spec->sharers);
+	fprintf(out, "; stride %d, %d%% of shared accesses locked, %d compute instructions per access, seed %u\n",
+		spec->stride, spec->lockPercent, spec->compute, spec->seed);
+	emitConstant(out, 2, spec->accesses / bodyAccesses);
+	emitConstant(out, 3, GEN_SHARED_BASE + (core + 1) * spec->workingSet);
+	emitConstant(out, 4, GEN_SHARED_BASE);
+	emitConstant(out, 7, spec->workingSet);
+	emitConstant(out, 8, spec->stride);
+	fprintf(out, "loop:\n");
+
+	for (i = 0; i < bodyAccesses; i++)
+	{
+		shared = core < spec->sharers && drawPercent(&state, spec->sharedPercent);
+		if (shared && drawPercent(&state, spec->lockPercent))
+			emitLockedAccess(out, &label);
+		else if (shared)
+			emitAccess(out, drawPercent(&state, spec->readPercent), 4, 6, &label);
+		else
+			emitAccess(out, drawPercent(&state, spec->readPercent), 3, 5, &label);
+
+		for (j = 0; j < spec->compute; j++)
+			fprintf(out, "        %s\n", computeOps[nextRandom(&state) % NUM_COMPUTE_OPS]);
+	}
+
+	fprintf(out, "        sub $r2, $r2, 1\n");
+	fprintf(out, "        bne $r1, $r2, $r0, loop\n");
+	fprintf(out, "        halt\n");
+}
+
+int generateWorkload(const WorkloadSpec* spec, char* dir)
+{
+	char fileName[MAX_GEN_PATH];
+	FILE* out;
+	int core;
+
+	if (!validateWorkloadSpec(spec))
+		return 0;
+
+	for (core = 0; core < NUM_CORES; core++)
+	{
+		snprintf(fileName, MAX_GEN_PATH, "%.400s/prog%d.asm", dir, core + 1);
+		if ((out = fopen(fileName, "w")) == NULL)
+		{
+			fprintf(stderr, "Could not write %s.\n", fileName);
+			return 0;
+		}
+		generateProgram(out, spec, core);
+		fclose(out);
+	}
+	return 1;
+}
@@ -0,0 +1,58 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "Shared.h"
+
+#define GEN_BODY_ACCESSES 32    /* Memory accesses in the loop body of a generated program */
+#define GEN_SHARED_BASE 4096    /* First word of the region shared by the cores */
+#define GEN_LOCK_ADDR 64        /* Word of the ll/sc lock */
+
+/* Synthetic workload generator
+ *
+ * Emits one assembly program per core from a specification. Each program is
+ * a loop over a body of GEN_BODY_ACCESSES memory accesses, repeated until the
+ * core has made the requested number of accesses. Every access walks its
+ * region by the stride, wrapping at the working set, and is followed by the
+ * compute instructions. The kind of each access (load or store, private or
+ * shared, locked or not) is drawn from a pseudo-random generator seeded with
+ * the seed and the core, so a specification always gives the same programs.
+ *
+ * The specification file has one parameter per line followed by its value,
+ * '#' starts a comment:
+ *
+ *   working_set    4096    words each core walks, in its private region and the shared one
+ *   accesses       10000   memory accesses per core
+ *   read_percent   70      share of the accesses that are loads
+ *   shared_percent 30      share of the accesses of a sharer going to the shared region
+ *   sharers        4       cores that access the shared region, 1 - 4
+ *   stride         1       words between consecutive accesses to a region
+ *   lock_percent   10      share of the shared accesses done as an increment under the lock
+ *   compute        2       ALU instructions after each access
+ *   seed           1
+ */
+
+typedef struct
+{
+	int workingSet;
+	int accesses;
+	int readPercent;
+	int sharedPercent;
+	int sharers;
+	int stride;
+	int lockPercent;
+	int compute;
+	unsigned int seed;
+} WorkloadSpec;
+
+void getDefaultWorkloadSpec(WorkloadSpec* spec);
+// Read a specification file over the defaults, returns 0 on errors
+int readWorkloadSpec(char* fileName, WorkloadSpec* spec);
+// Returns 0 and reports the first parameter out of range
+int validateWorkloadSpec(const WorkloadSpec* spec);
+
+// Write the program of a core
+void generateProgram(FILE* out, const WorkloadSpec* spec, int core);
+// Write prog1.asm - prog4.asm into dir, returns 0 on errors
+int generateWorkload(const WorkloadSpec* spec, char* dir);
+
+#endif
@@ -0,0 +1,91 @@
+#include <string.h>
+#include "Histogram.h"
+
+void clearHistogram(LatencyHistogram* histogram)
+{
+	memset(histogram, 0, sizeof(LatencyHistogram));
+}
+
+// Bucket of a value: its top three bits and how far they were shifted
+int getHistogramBucket(int value)
+{
+	int shift = 0;
+
+	if (value < 8)
+		return value;
+	while ((value >> shift) >= 8)
+		shift++;
+	return 8 + (shift - 1) * 4 + ((value >> shift) - 4);
+}
+
+// Largest value of a bucket
+int getHistogramBucketLimit(int bucket)
+{
+	int shift;
+
+	if (bucket < 8)
+		return bucket;
+	shift = (bucket - 8) / 4 + 1;
+	return (int)((((unsigned int)(bucket - 8) % 4 + 5) << shift) - 1);
+}
+
+void recordLatency(LatencyHistogram* histogram, int value)
+{
+	if (value < 0)
+		value = 0;
+	histogram->buckets[getHistogramBucket(value)]++;
+	histogram->count++;
+	if (value > histogram->max)
+		histogram->max = value;
+}
+
+void mergeHistogram(LatencyHistogram* into, const LatencyHistogram* from)
+{
+	int i;
+
+	for (i = 0; i < HISTOGRAM_BUCKETS; i++)
+		into->buckets[i] += from->buckets[i];
+	into->count += from->count;
+	if (from->max > into->max)
+		into->max = from->max;
+}
+
+void subtractHistogram(LatencyHistogram* from, const LatencyHistogram* earlier)
+{
+	int i, top = -1;
+
+	for (i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		from->buckets[i] -= earlier->buckets[i];
+		if (from->buckets[i] > 0)
+			top = i;
+	}
+	from->count -= earlier->count;
+	if (top < 0)
+		from->max = 0;
+	else if (getHistogramBucketLimit(top) < from->max)
+		from->max = getHistogramBucketLimit(top);
+}
+
+int getHistogramPercentile(const LatencyHistogram* histogram, int percent)
+{
+	long long rank = ((long long)histogram->count * percent + 99) / 100;
+	long long seen = 0;
+	int i, limit;
+
+	if (histogram->count == 0)
+		return 0;
+	if (rank < 1)
+		rank = 1;
+
+	for (i = 0; i < HISTOGRAM_BUCKETS; i++)
+	{
+		seen += histogram->buckets[i];
+		if (seen >= rank)
+		{
+			limit = getHistogramBucketLimit(i);
+			return (limit < histogram->max) ? limit : histogram->max;
+		}
+	}
+	return histogram->max;
+}
@@ -0,0 +1,33 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include "Shared.h"
+
+#define HISTOGRAM_BUCKETS 120   /* Enough for any non-negative int */
+
+/* Log-bucketed latency histogram
+ *
+ * Values below 8 have a bucket each, above that every power of two is split
+ * into four buckets, so a bucket is at most 25% wide relative to its values.
+ * Recording is a few shifts, and histograms of the same kind of latency are
+ * merged by adding their buckets. Percentiles are reported as the upper
+ * bound of the bucket holding them, never above the largest value seen.
+ */
+
+typedef struct
+{
+	int buckets[HISTOGRAM_BUCKETS];
+	int count;
+	int max;
+} LatencyHistogram;
+
+void clearHistogram(LatencyHistogram* histogram);
+// Negative values are recorded as 0
+void recordLatency(LatencyHistogram* histogram, int value);
+void mergeHistogram(LatencyHistogram* into, const LatencyHistogram* from);
+// Remove the values of an earlier copy of the same histogram, the max becomes the bound of the top bucket left
+void subtractHistogram(LatencyHistogram* from, const LatencyHistogram* earlier);
+// Value below which percent of the recorded values lie, 100 gives the max, 0 when empty
+int getHistogramPercentile(const LatencyHistogram* histogram, int percent);
+
+#endif
@@ -1,187 +1,468 @@
-#include "Shared.h"
-#include "MSIBus.h"
-
-MSIBus createMSIBus()
-{
-	MSIBus bus = (MSIBus)malloc(sizeof(struct MSIBus_));
-	return bus;
-}
-
-void destroyMSIBus(MSIBus bus)
-{
-	free(bus);
-}
-
-void initializeMSIBus(MSIBus bus, struct Pipeline* pipes[], Cache caches[], Memory mem)
-{
-	int i,j;
-
-	for (i = 0; i < NUM_CORES; i++)
-	{
-		bus->pipes[i] = pipes[i];
-		bus->caches[i] = caches[i];
-	}
-	bus->mem = mem;
-	bus->busCmd = NoCommand;
-	bus->busBusy = False;
-	bus->busWaitCycles = 0;
-	bus->BusTraceFile = openFileForBusTrace();
-	/* Initialize core watch flags */
-	for (i = 0; i < NUM_CORES; i++)
-		for (j = 0; j < MEM_SIZE; j++)
-			bus->coreWatchFlags[i][j] = NotWatched; // Not watched
-}
-FILE* openFileForBusTrace()
-{
-	FILE *fptr = fopen("bustrace.txt", "w");
-	if (fptr == NULL)
-	{
-		printf("Error!");
-		exit(1);
-	}
-	return fptr;
-}
-
-//this function been called every memory read/write transiction
-void busTrace(MSIBus bus, BusOrigId coreId, int address)
-{
-	fprintf(bus->BusTraceFile, "%d %d %d %d %d\n", 
-			bus->pipes[coreId]->totalCycles, bus->busOrigid, bus->busCmd, bus->busAddr, bus->busData);
-}
-
-void processorRead(MSIBus bus, BusOrigId coreId, int address)
-{
-	char Bits[NUM_MSI_BITS];
-	
-	if (coreId < 0 || coreId >= NUM_CORES)
-	{
-		fprintf(stderr, "Error in function processorRead: core id is out of range");
-		return;
-	}
-
-	getMSIBits(bus->caches[coreId], address, Bits);
-	// the block is invalid, move to share
-	// invalid: normal busRd transction since the block is not in the cache
-	if (Bits[I_BIT] == 1)
-	{
-		Bits[I_BIT] = 0;
-		Bits[S_BIT] = 1;
-		Bits[M_BIT] = 0;
-		setMSIBits(bus->caches[coreId], address, Bits); // MSI bits update is done before the end of busRdX
-		busRd(bus, coreId, address);
-	}
-
-}
-
-void processorWrite(MSIBus bus, BusOrigId coreId, int address, int data )
-{
-	char Bits[NUM_MSI_BITS];
-
-	if (coreId < 0 || coreId >= NUM_CORES)
-	{
-		fprintf(stderr, "Error in function processorRead: core id is out of range");
-		return;
-	}
-
-	getMSIBits(bus->caches[coreId], address, Bits);
-	
-	if (Bits[I_BIT] == 1 || Bits[S_BIT] == 1)
-	{
-		Bits[I_BIT] = 0;
-		Bits[S_BIT] = 1;
-		Bits[M_BIT] = 0;
-		setMSIBits(bus->caches[coreId], address, Bits); // MSI bits update is done before the end of busRdX
-		busRdX(bus, coreId, address);
-	}
-}
-
-void busRd(MSIBus bus, BusOrigId coreId, int address )
-{
-	int i;
-	int data, status;
-	char foundInAnyCache = 0;	
-
-	for (i = 0; i < NUM_CORES; i++)
-	{
-		status = readFromCache( bus->caches[i], address, &data );
-		if (status == 1) /* Hit in another cache */
-		{
-			bus->busData = data;
-			foundInAnyCache = 1;
-
-			char Bits[NUM_MSI_BITS];
-			getMSIBits(bus->caches[i], address, Bits);
-			if (Bits[M_BIT] == 1)
-			{
-				Bits[I_BIT] = 0;
-				Bits[S_BIT] = 1;
-				Bits[M_BIT] = 0;
-				setMSIBits(bus->caches[i], address, Bits); 
-				//flush(MSIBus bus, i, address, data)
-			}
-
-		}
-	}
-	if (foundInAnyCache == 0)
-		bus->busData = readMemory(bus->mem, address);
-}
-
-//write data to memory
-void flush(MSIBus bus, BusOrigId coreId, int address, int data)
-{
-	int writeStatus = writeMemory(bus->mem, address, data);
-	if (writeStatus == 1)
-	{
-		writeStatus = MemStatus advanceMemoryClock(bus->mem);
-		if (writeStatus == 1)
-			freeMemory(bus->mem);
-	}
-}
-
-void busRdX( MSIBus bus, BusOrigId coreId, int address )
-{
-	int i;
-	int data, status;
-	char foundInAnyCache = 0;
-
-	for (i = 0; i < NUM_CORES; i++)
-	{
-		status = readFromCache(bus->caches[i], address, &data);
-		if (status == 1) /* Hit in another cache */
-		{
-			bus->busData = data;
-			foundInAnyCache = 1;
-		}
-	}
-	if (foundInAnyCache == 0)
-		bus->busData = readMemory(bus->mem, address);
-}
-
-void advanceMSIBusClock(MSIBus bus, MemStatus memStatus)
-{
-	if ( bus->busBusy && bus->busWaitCycles > 0 )
-		bus->busWaitCycles--;
-	// Unfreeze pipelines
-}
-
-void setCoreWatchFlag(MSIBus bus, BusOrigId coreId, unsigned int addr)
-{
-	bus->coreWatchFlags[coreId][addr] = Watched;
-}
-
-bool getCoreWatchResult(MSIBus bus, BusOrigId coreId, unsigned int addr)
-{
-	int i;
-
-	if (bus->coreWatchFlags[coreId][addr] == (char)NotWatched || bus->coreWatchFlags[coreId][addr] == (char)Watched ||
-		bus->coreWatchFlags[coreId][addr] == (char)coreId )
-	{
-		for (i = 0; i < NUM_CORES; i++)
-			if ( bus->coreWatchFlags[coreId][addr] == Watched )
-				bus->coreWatchFlags[coreId][addr] = (char)coreId; // Mark as successfull SC operation
-
-		return True; // allow sc command
-	}
-	
-	return False;
-}
\ No newline at end of file
+#include <string.h>
+#include "Shared.h"
+#include "MSIBus.h"
+#include "Profile.h"
+
+static const char* busLatencyNames[NumBusLatencies] = { "missLatency", "arbitrationWait", "memoryService" };
+static const char* busCommandNames[NumBusCommands] = { "none", "busRd", "busRdX", "flush" };
+
+MSIBus createMSIBus()
+{
+	MSIBus bus = (MSIBus)malloc(sizeof(struct MSIBus_));
+	return bus;
+}
+
+void destroyMSIBus(MSIBus bus)
+{
+	if (bus == NULL)
+		return;
+	if (bus->BusTraceFile != NULL)
+		fclose(bus->BusTraceFile);
+	free(bus->migratory);
+	free(bus);
+}
+
+int initializeMSIBus(MSIBus bus, struct Pipeline* pipes[], Cache caches[], Memory mem, char* traceFileName)
+{
+	int i;
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		bus->pipes[i] = pipes[i];
+		bus->caches[i] = caches[i];
+		bus->pendingCmd[i] = NoCommand;
+		bus->pendingAddr[i] = 0;
+	}
+	for (i = 0; i < NumBusCommands; i++)
+		bus->cmdCount[i] = 0;
+	bus->busExclusive = False;
+	bus->migratory = NULL;
+	bus->migratoryLines = 0;
+	bus->migratoryGrants = 0;
+	bus->migratorySaved = 0;
+	bus->migratoryReverts = 0;
+	for (i = 0; i < NUM_CORES; i++)
+		bus->requestCycle[i] = 0;
+	bus->grantCycle = 0;
+	memset(bus->latencies, 0, sizeof(bus->latencies));
+	bus->mem = mem;
+	bus->busCmd = NoCommand;
+	bus->busBusy = False;
+	bus->busWaitCycles = 0;
+	bus->busSupplier = MEMId;
+	bus->nextCore = 0;
+	bus->cycle = 0;
+	/* Initialize core watch flags, all addresses are not watched */
+	memset(bus->coreWatchFlags, (char)NotWatched, sizeof(bus->coreWatchFlags));
+	bus->BusTraceFile = NULL;
+	if (traceFileName != NULL)
+	{
+		bus->BusTraceFile = openFileForBusTrace(traceFileName);
+		if (bus->BusTraceFile == NULL)
+			return 0;
+	}
+	return 1;
+}
+FILE* openFileForBusTrace(char* fileName)
+{
+	FILE *fptr = fopen(fileName, "w");
+	if (fptr == NULL)
+		fprintf(stderr, "Could not open bus trace file %s.\n", fileName);
+	return fptr;
+}
+
+//this function been called every memory read/write transiction
+void busTrace(MSIBus bus, BusOrigId coreId, int address)
+{
+	bus->cmdCount[bus->busCmd]++;
+	if (bus->BusTraceFile == NULL)
+		return;
+	fprintf(bus->BusTraceFile, "%d %d %d %d %d\n", 
+			bus->cycle, bus->busOrigid, bus->busCmd, bus->busAddr, bus->busData);
+}
+
+// Queue a read miss of the core, it is sent when the core wins the bus
+void processorRead(MSIBus bus, BusOrigId coreId, int address)
+{
+	if (coreId < 0 || coreId >= NUM_CORES)
+	{
+		fprintf(stderr, "Error in function processorRead: core id is out of range");
+		return;
+	}
+
+	bus->pendingCmd[coreId] = BusRd;
+	bus->pendingAddr[coreId] = address;
+	bus->requestCycle[coreId] = bus->cycle;
+}
+
+// Queue a write miss (or upgrade of a shared block) of the core
+void processorWrite(MSIBus bus, BusOrigId coreId, int address, int data )
+{
+	if (coreId < 0 || coreId >= NUM_CORES)
+	{
+		fprintf(stderr, "Error in function processorWrite: core id is out of range");
+		return;
+	}
+
+	bus->pendingCmd[coreId] = BusRdx;
+	bus->pendingAddr[coreId] = address;
+	bus->requestCycle[coreId] = bus->cycle;
+}
+
+bool snoopMigratory(MSIBus bus, BusOrigId coreId, int address, BusCommand cmd)
+{
+	MigratoryLine* line;
+	Block block, owner = NULL;
+	int i, copies = 0;
+
+	if (bus->migratory == NULL)
+		return False;
+	line = &bus->migratory[address];
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		if (i == coreId)
+			continue;
+		block = findBlock(bus->caches[i], address);
+		if (block != NULL && block->invalid == 0)
+		{
+			copies++;
+			if (block->modified == 1)
+				owner = block;
+		}
+	}
+
+	/* Writing a granted copy clears its shared bit */
+	if (line->granted && owner != NULL)
+	{
+		if (owner->shared == 0)
+			bus->migratorySaved++;
+		else if (cmd == BusRd)
+		{
+			line->migratory = 0;
+			line->confidence = 0;
+			bus->migratoryReverts++;
+		}
+	}
+	line->granted = 0;
+
+	if (cmd == BusRd)
+	{
+		if (!line->migratory || copies > (owner != NULL))
+			return False;
+		line->granted = 1;
+		line->lastWriter = (signed char)coreId;
+		bus->migratoryGrants++;
+		return True;
+	}
+
+	block = findBlock(bus->caches[coreId], address);
+	if (!line->migratory && copies == 1 && block != NULL && block->invalid == 0 &&
+		line->lastWriter >= 0 && line->lastWriter != coreId &&
+		(block = findBlock(bus->caches[(int)line->lastWriter], address)) != NULL && block->invalid == 0)
+	{
+		if (line->confidence < MIGRATORY_CONFIDENCE)
+			line->confidence++;
+		if (line->confidence == MIGRATORY_CONFIDENCE)
+		{
+			line->migratory = 1;
+			if (!line->classified)
+				bus->migratoryLines++;
+			line->classified = 1;
+		}
+	}
+	line->lastWriter = (signed char)coreId;
+	return False;
+}
+
+// Snoop the other caches for a read: a modified copy is flushed and moves to
+// shared, or is invalidated when the line is granted exclusively
+void busRd(MSIBus bus, BusOrigId coreId, int address )
+{
+	int i;
+	Block block;
+	PROFILE_SCOPE(ProfileBusRd);
+
+	bus->busExclusive = snoopMigratory(bus, coreId, address, BusRd);
+	bus->busSupplier = MEMId;
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		if (i == coreId)
+			continue;
+
+		block = findBlock(bus->caches[i], address);
+		if (block != NULL && block->invalid == 0 && block->modified == 1) /* Modified in another cache */
+		{
+			char Bits[NUM_MSI_BITS];
+			bus->busData = block->data;
+			bus->busSupplier = (BusOrigId)i;
+
+			Bits[I_BIT] = bus->busExclusive;
+			Bits[S_BIT] = !bus->busExclusive;
+			Bits[M_BIT] = 0;
+			setMSIBits(bus->caches[i], address, Bits);
+		}
+	}
+	if (bus->busSupplier == MEMId)
+		readMemory(bus->mem, address);
+}
+
+//write data to memory
+void flush(MSIBus bus, BusOrigId coreId, int address, int data)
+{
+	BusOrigId origId = bus->busOrigid;
+	BusCommand cmd = bus->busCmd;
+	int addr = bus->busAddr;
+	int busData = bus->busData;
+
+	bus->mem->data[address] = data;
+
+	bus->busOrigid = coreId;
+	bus->busCmd = Flush;
+	bus->busAddr = address;
+	bus->busData = data;
+	busTrace(bus, coreId, address);
+
+	bus->busOrigid = origId;
+	bus->busCmd = cmd;
+	bus->busAddr = addr;
+	bus->busData = busData;
+}
+
+// Snoop the other caches for a write: every other copy is invalidated,
+// a modified copy supplies the data
+void busRdX( MSIBus bus, BusOrigId coreId, int address )
+{
+	int i;
+	Block block;
+	char Bits[NUM_MSI_BITS];
+	PROFILE_SCOPE(ProfileBusRdX);
+
+	snoopMigratory(bus, coreId, address, BusRdx);
+	bus->busExclusive = False;
+	bus->busSupplier = MEMId;
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		if (i == coreId)
+			continue;
+
+		block = findBlock(bus->caches[i], address);
+		if (block != NULL && block->invalid == 0) /* Hit in another cache */
+		{
+			if (block->modified == 1)
+			{
+				bus->busData = block->data;
+				bus->busSupplier = (BusOrigId)i;
+			}
+			Bits[I_BIT] = 1;
+			Bits[S_BIT] = 0;
+			Bits[M_BIT] = 0;
+			setMSIBits(bus->caches[i], address, Bits);
+		}
+	}
+	if (bus->busSupplier == MEMId)
+		readMemory(bus->mem, address);
+}
+
+// Put the data on the bus into the requesting cache and release the core
+void completeBusTransaction(MSIBus bus)
+{
+	int evictAddr, evictData;
+	BusOrigId coreId = bus->busOrigid;
+
+	if (bus->busSupplier == MEMId)
+	{
+		freeMemory(bus->mem);
+		recordLatency(&bus->latencies[MemoryService][coreId][bus->busCmd], bus->cycle - bus->grantCycle);
+	}
+	recordLatency(&bus->latencies[MissLatency][coreId][bus->busCmd], bus->cycle + 1 - bus->requestCycle[coreId]);
+	flush(bus, bus->busSupplier, bus->busAddr, bus->busData);
+
+	if (addBlockToCache(bus->caches[coreId], bus->busAddr, bus->busData, bus->busCmd == BusRdx || bus->busExclusive,
+		&evictAddr, &evictData) == 2)
+		flush(bus, coreId, evictAddr, evictData);
+	if (bus->busCmd == BusRd && bus->busExclusive)
+	{
+		char Bits[NUM_MSI_BITS];
+		Bits[I_BIT] = 0;
+		Bits[S_BIT] = 1; /* Until the core writes it */
+		Bits[M_BIT] = 1;
+		setMSIBits(bus->caches[coreId], bus->busAddr, Bits);
+	}
+
+	bus->pendingCmd[coreId] = NoCommand;
+	bus->busCmd = NoCommand;
+	bus->busBusy = False;
+	unfreezePipeline(bus->pipes[coreId]);
+}
+
+// Give the bus to the next core with a pending request
+void arbitrateBus(MSIBus bus)
+{
+	int i, coreId;
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		coreId = (bus->nextCore + i) % NUM_CORES;
+		if (bus->pendingCmd[coreId] == NoCommand)
+			continue;
+
+		bus->busBusy = True;
+		bus->busOrigid = (BusOrigId)coreId;
+		bus->busCmd = bus->pendingCmd[coreId];
+		bus->busAddr = bus->pendingAddr[coreId];
+		bus->busData = 0;
+		bus->grantCycle = bus->cycle;
+		recordLatency(&bus->latencies[ArbitrationWait][coreId][bus->busCmd], bus->cycle - bus->requestCycle[coreId]);
+		busTrace(bus, coreId, bus->busAddr);
+
+		if (bus->busCmd == BusRd)
+			busRd(bus, coreId, bus->busAddr);
+		else
+			busRdX(bus, coreId, bus->busAddr);
+
+		/* A cache flushes on the next cycle, memory answers after its latency */
+		bus->busWaitCycles = (bus->busSupplier == MEMId) ? 0 : 1;
+		bus->nextCore = (coreId + 1) % NUM_CORES;
+		return;
+	}
+}
+
+void advanceMSIBusClock(MSIBus bus, MemStatus memStatus)
+{
+	PROFILE_SCOPE(ProfileBusClock);
+	if (bus->busBusy)
+	{
+		if (bus->busSupplier != MEMId && bus->busWaitCycles > 0)
+		{
+			if (--bus->busWaitCycles == 0)
+				completeBusTransaction(bus);
+		}
+		else if (bus->busSupplier == MEMId && memStatus == MemReadFinished)
+		{
+			bus->busData = bus->mem->curData;
+			completeBusTransaction(bus);
+		}
+	}
+	else
+		arbitrateBus(bus);
+
+	bus->cycle++;
+}
+
+// The link of the core's LL to the address is unbroken
+bool isCoreWatching(MSIBus bus, BusOrigId coreId, unsigned int addr)
+{
+	return bus->coreWatchFlags[coreId][addr] == (char)Watched;
+}
+
+void setCoreWatchFlag(MSIBus bus, BusOrigId coreId, unsigned int addr)
+{
+	bus->coreWatchFlags[coreId][addr] = Watched;
+}
+
+// Break the link of every other core watching the address
+void breakCoreWatches(MSIBus bus, BusOrigId coreId, unsigned int addr)
+{
+	int i;
+
+	for (i = 0; i < NUM_CORES; i++)
+		if ( i != coreId && bus->coreWatchFlags[i][addr] == (char)Watched )
+			bus->coreWatchFlags[i][addr] = (char)coreId; // Mark as failed by successfull SC of coreId
+}
+
+// SC succeeds when no other core did a successful SC or atomic to the address since the LL
+bool getCoreWatchResult(MSIBus bus, BusOrigId coreId, unsigned int addr)
+{
+	if ( bus->coreWatchFlags[coreId][addr] == (char)Watched )
+	{
+		breakCoreWatches(bus, coreId, addr);
+		bus->coreWatchFlags[coreId][addr] = (char)NotWatched;
+		return True; // allow sc command
+	}
+	
+	bus->coreWatchFlags[coreId][addr] = (char)NotWatched;
+	return False;
+}
+
+void registerBusStats(MSIBus bus, StatsRegistry reg)
+{
+	char name[MAX_STAT_NAME];
+	int i, core, cmd;
+
+	registerCounter(reg, "bus", "cycles", &bus->cycle);
+	registerCounter(reg, "bus", "busRd", &bus->cmdCount[BusRd]);
+	registerCounter(reg, "bus", "busRdX", &bus->cmdCount[BusRdx]);
+	registerCounter(reg, "bus", "flush", &bus->cmdCount[Flush]);
+	if (bus->migratory != NULL)
+	{
+		registerCounter(reg, "bus", "migratoryLines", &bus->migratoryLines);
+		registerCounter(reg, "bus", "migratoryGrants", &bus->migratoryGrants);
+		registerCounter(reg, "bus", "migratorySaved", &bus->migratorySaved);
+		registerCounter(reg, "bus", "migratoryReverts", &bus->migratoryReverts);
+	}
+	for (i = 0; i < NumBusLatencies; i++)
+		for (core = 0; core < NUM_CORES; core++)
+			for (cmd = BusRd; cmd <= BusRdx; cmd++)
+			{
+				snprintf(name, MAX_STAT_NAME, "%s.core%d.%s", busLatencyNames[i], core, busCommandNames[cmd]);
+				registerHistogram(reg, "bus", name, &bus->latencies[i][core][cmd]);
+			}
+}
+
+int enableMigratoryOptimization(MSIBus bus)
+{
+	int addr;
+
+	if ((bus->migratory = (MigratoryLine*)calloc(MEM_SIZE, sizeof(MigratoryLine))) == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for the migratory sharing table.\n");
+		return 0;
+	}
+	for (addr = 0; addr < MEM_SIZE; addr++)
+		bus->migratory[addr].lastWriter = -1;
+	return 1;
+}
+
+void printMigratoryReport(MSIBus bus, FILE* out)
+{
+	fprintf(out, "Migratory lines %d, exclusive reads %d, BusRdX saved %d, reverted %d\n",
+		bus->migratoryLines, bus->migratoryGrants, bus->migratorySaved, bus->migratoryReverts);
+}
+
+const char* getBusLatencyName(BusLatency latency)
+{
+	return busLatencyNames[latency];
+}
+
+// One line of the latency report
+void printLatencyLine(FILE* out, const char* latency, const char* requester, const char* cmd,
+	const LatencyHistogram* histogram)
+{
+	fprintf(out, "%-16s %-6s %-7s %8d %6d %6d %6d %6d\n", latency, requester, cmd, histogram->count,
+		getHistogramPercentile(histogram, 50), getHistogramPercentile(histogram, 90),
+		getHistogramPercentile(histogram, 99), histogram->max);
+}
+
+void printLatencyReport(MSIBus bus, StatsRegistry reg, FILE* out)
+{
+	LatencyHistogram all, region;
+	char requester[16];
+	int i, core, cmd;
+
+	fprintf(out, "%-16s %-6s %-7s %8s %6s %6s %6s %6s\n", "latency", "core", "command", "count", "p50", "p90",
+		"p99", "max");
+	for (i = 0; i < NumBusLatencies; i++)
+		for (cmd = BusRd; cmd <= BusRdx; cmd++)
+		{
+			clearHistogram(&all);
+			for (core = 0; core < NUM_CORES; core++)
+			{
+				sprintf(requester, "core%d", core);
+				readRegisteredHistogram(reg, &bus->latencies[i][core][cmd], &region);
+				printLatencyLine(out, busLatencyNames[i], requester, busCommandNames[cmd], &region);
+				mergeHistogram(&all, &region);
+			}
+			printLatencyLine(out, busLatencyNames[i], "all", busCommandNames[cmd], &all);
+		}
+}
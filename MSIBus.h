@@ -1,54 +1,111 @@
-#ifndef MSI_BUS_H
-#define MSI_BUS_H
-
-#include "Shared.h"
-#include "Pipeline2.h"
-#include "Cache.h"
-#include "Memory.h"
-
-typedef enum {Core0Id = 0, Core1Id, Core2Id, Core3Id, MEMId = NUM_CORES} BusOrigId;
-typedef enum {NoCommand = 0, BusRd, BusRdx, Flush } BusCommand;
-typedef enum {BusFail = -1, BusSuccess = 0, BusWait } BusStatus;
-typedef enum {NotWatched = -1, Core0SC = 0, Core1SC, Core2SC, Core3SC, Watched} WatchFlag;
-
-struct Pipeline;
-struct MSIBus_
-{
-	struct Pipeline *pipes[NUM_CORES];
-	Cache caches[NUM_CORES];
-	Memory mem;
-	BusOrigId busOrigid;
-	BusCommand busCmd;
-	int busAddr;
-	int busData;
-	bool busBusy;
-	int busWaitCycles;
-	FILE* BusTraceFile;
-	char coreWatchFlags[NUM_CORES][MEM_SIZE];
-};
-typedef struct MSIBus_* MSIBus;
-/*
-struct BusTrace_
-{
-	int currCycle;
-	BusOrigId busOrigid;
-	BusCommand busCmd;
-	
-};
-typedef struct BusTrace_* BusTrace;
-*/
-MSIBus createMSIBus();
-void destroyMSIBus( MSIBus bus );
-void initializeMSIBus(MSIBus bus, struct Pipeline* pipes[], Cache caches[], Memory mem);
-void processorRead   ( MSIBus bus, BusOrigId coreId, int address );
-void processorWrite  ( MSIBus bus, BusOrigId coreId, int address, int data );
-void busRd ( MSIBus bus, BusOrigId coreId, int address );
-void busRdX( MSIBus bus, BusOrigId coreId, int address );
-void advanceMSIBusClock(MSIBus bus, MemStatus memStatus);
-void setCoreWatchFlag  (MSIBus bus, BusOrigId coreId, unsigned int addr);
-WatchFlag getCoreWatchResult(MSIBus bus, BusOrigId coreId, unsigned int addr);
-
-void openFileForBusTrace();
-void busTrace(MSIBus bus, BusOrigId coreId, int address);
-void flush(MSIBus bus, BusOrigId coreId, int address, int data);
-#endif
+#ifndef MSI_BUS_H
+#define MSI_BUS_H
+
+#include "Shared.h"
+#include "Pipeline2.h"
+#include "Cache.h"
+#include "Memory.h"
+#include "Histogram.h"
+
+typedef enum {Core0Id = 0, Core1Id, Core2Id, Core3Id, MEMId = NUM_CORES} BusOrigId;
+typedef enum {NoCommand = 0, BusRd, BusRdx, Flush, NumBusCommands } BusCommand;
+typedef enum {BusFail = -1, BusSuccess = 0, BusWait } BusStatus;
+typedef enum {NotWatched = -1, Core0SC = 0, Core1SC, Core2SC, Core3SC, Watched} WatchFlag;
+
+/* Adaptive migratory sharing
+ *
+ * A BusRdX of a core that read the line while its only other copy was held
+ * by the last writer marks the line migratory. A BusRd of a migratory line
+ * that no other core holds shared takes it exclusively, invalidating the
+ * owner in the same transaction, so the write that follows needs no BusRdX.
+ * The granted copy is marked modified and shared until its core writes it;
+ * a grant found unwritten by the next read returns the line to plain MSI.
+ */
+#ifndef MIGRATORY_CONFIDENCE
+#define MIGRATORY_CONFIDENCE 2   /* Handoffs that classify a line migratory */
+#endif
+
+/* Latencies of the requests of each core, by command. A miss runs from the
+   cycle the core asked for the block to the cycle it can retry the access,
+   the arbitration wait until the request wins the bus, and the memory
+   service from then until memory answers. */
+typedef enum { MissLatency = 0, ArbitrationWait, MemoryService, NumBusLatencies } BusLatency;
+
+typedef struct
+{
+	signed char lastWriter;  /* Core that last took ownership, -1 if none */
+	char migratory;
+	char confidence;         /* Handoffs seen since the last revert */
+	char granted;            /* The owner got the line on a read */
+	char classified;         /* Counted in migratoryLines */
+} MigratoryLine;
+
+struct Pipeline;
+struct MSIBus_
+{
+	struct Pipeline *pipes[NUM_CORES];
+	Cache caches[NUM_CORES];
+	Memory mem;
+	BusOrigId busOrigid;
+	BusCommand busCmd;
+	int busAddr;
+	int busData;
+	bool busBusy;
+	int busWaitCycles;
+	BusOrigId busSupplier;               /* Core flushing the data, MEMId when memory supplies it */
+	BusCommand pendingCmd[NUM_CORES];    /* Request waiting for the bus, one per core */
+	int pendingAddr[NUM_CORES];
+	int nextCore;                        /* Round robin arbitration */
+	int cycle;
+	int cmdCount[NumBusCommands];
+	bool busExclusive;                   /* The BusRd on the bus was granted an exclusive copy */
+	MigratoryLine* migratory;            /* Per memory word, NULL without the migratory optimization */
+	int migratoryLines;                  /* Lines classified migratory at least once */
+	int migratoryGrants;                 /* Reads answered with an exclusive copy */
+	int migratorySaved;                  /* Grants found written, each saved a BusRdX */
+	int migratoryReverts;                /* Grants found unwritten, the line went back to MSI */
+	int requestCycle[NUM_CORES];         /* Cycle each pending request was made */
+	int grantCycle;                      /* Cycle the request on the bus won it */
+	LatencyHistogram latencies[NumBusLatencies][NUM_CORES][NumBusCommands];
+	FILE* BusTraceFile;
+	char coreWatchFlags[NUM_CORES][MEM_SIZE];
+};
+typedef struct MSIBus_* MSIBus;
+/*
+struct BusTrace_
+{
+	int currCycle;
+	BusOrigId busOrigid;
+	BusCommand busCmd;
+	
+};
+typedef struct BusTrace_* BusTrace;
+*/
+MSIBus createMSIBus();
+void destroyMSIBus( MSIBus bus );
+/* traceFileName may be NULL to run without a bus trace, returns 0 when the trace cannot be opened */
+int initializeMSIBus(MSIBus bus, struct Pipeline* pipes[], Cache caches[], Memory mem, char* traceFileName);
+void processorRead   ( MSIBus bus, BusOrigId coreId, int address );
+void processorWrite  ( MSIBus bus, BusOrigId coreId, int address, int data );
+// Track the migratory state of the line, returns True when a BusRd gets an exclusive copy
+bool snoopMigratory(MSIBus bus, BusOrigId coreId, int address, BusCommand cmd);
+void busRd ( MSIBus bus, BusOrigId coreId, int address );
+void busRdX( MSIBus bus, BusOrigId coreId, int address );
+void advanceMSIBusClock(MSIBus bus, MemStatus memStatus);
+void registerBusStats(MSIBus bus, StatsRegistry reg);
+// Returns 0 when the line table cannot be allocated
+int enableMigratoryOptimization(MSIBus bus);
+void printMigratoryReport(MSIBus bus, FILE* out);
+const char* getBusLatencyName(BusLatency latency);
+// Print p50, p90, p99 and max of each latency per core and command, and for all cores,
+// since the last reset of the registry the histograms are registered in
+void printLatencyReport(MSIBus bus, StatsRegistry reg, FILE* out);
+void setCoreWatchFlag  (MSIBus bus, BusOrigId coreId, unsigned int addr);
+bool getCoreWatchResult(MSIBus bus, BusOrigId coreId, unsigned int addr);
+bool isCoreWatching    (MSIBus bus, BusOrigId coreId, unsigned int addr);
+void breakCoreWatches  (MSIBus bus, BusOrigId coreId, unsigned int addr);
+
+FILE* openFileForBusTrace(char* fileName);
+void busTrace(MSIBus bus, BusOrigId coreId, int address);
+void flush(MSIBus bus, BusOrigId coreId, int address, int data);
+#endif
@@ -1,13 +1,383 @@
-#include "MultiCoreComputer.h"
-
-int main()
-{
-	char* fileNames[4] = { "prog1.asm", "prog2.asm", "prog3.asm", "prog4.asm" };
-
-	Computer comp = CreateNewComputer();
-	initializeComputer(comp, fileNames);
-	runComputer(comp);
-	destroyComputer(comp);
-	
-	return 0;
-}
\ No newline at end of file
+#include <string.h>
+#include "MultiCoreComputer.h"
+#include "Sweep.h"
+#include "ProgramImage.h"
+#include "Bench.h"
+#include "Suite.h"
+#include "Generator.h"
+
+/* Assemble a program into a pre-assembled image:
+   sim -assemble prog.asm prog.bin */
+int assembleMain(int argc, char* argv[])
+{
+	Program prog;
+	int status;
+
+	if (argc != 4)
+	{
+		fprintf(stderr, "Usage: %s -assemble prog.asm prog.bin\n", argv[0]);
+		return 1;
+	}
+
+	if ((prog = loadProgram(argv[2])) == NULL)
+		return 1;
+	status = writeProgramImage(prog, argv[3]);
+	destroyProgram(prog);
+
+	return status ? 0 : 1;
+}
+
+/* Report host throughput of the assembler:
+   sim -bench-asm [lines] */
+int benchAsmMain(int argc, char* argv[])
+{
+	int numLines = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+	return benchAssembler(numLines) ? 0 : 1;
+}
+
+/* Report host throughput of the pipeline model:
+   sim -bench-sim [iterations] */
+int benchSimMain(int argc, char* argv[])
+{
+	int iterations = (argc > 2) ? atoi(argv[2]) : 1000000;
+
+	return benchSimulator(iterations) ? 0 : 1;
+}
+
+/* Report host throughput of the functional engine:
+   sim -bench-ff [iterations] [warm] */
+int benchFunctionalMain(int argc, char* argv[])
+{
+	int iterations = (argc > 2) ? atoi(argv[2]) : 4000000;
+	bool warm = (argc > 3 && atoi(argv[3]) != 0);
+
+	return benchFunctional(iterations, warm) ? 0 : 1;
+}
+
+/* Write the programs of a synthetic workload:
+   sim -generate spec.txt dir */
+int generateMain(int argc, char* argv[])
+{
+	WorkloadSpec spec;
+
+	if (argc != 4)
+	{
+		fprintf(stderr, "Usage: %s -generate spec.txt dir\n", argv[0]);
+		return 1;
+	}
+
+	if (!readWorkloadSpec(argv[2], &spec))
+		return 1;
+	return generateWorkload(&spec, argv[3]) ? 0 : 1;
+}
+
+/* Run the benchmark suite against its golden results and speed baseline:
+   sim -suite [dir] [baseline | update] */
+int suiteMain(int argc, char* argv[])
+{
+	char* dir = (argc > 2) ? argv[2] : "workloads";
+	SuiteMode mode = SuiteCheck;
+
+	if (argc > 3 && strcmp(argv[3], "baseline") == 0)
+		mode = SuiteBaseline;
+	else if (argc > 3 && strcmp(argv[3], "update") == 0)
+		mode = SuiteUpdate;
+	else if (argc > 3)
+	{
+		fprintf(stderr, "Usage: %s -suite [dir] [baseline | update]\n", argv[0]);
+		return 1;
+	}
+
+	return runSuite(dir, mode) ? 0 : 1;
+}
+
+/* Compare the throughput of locks and counters built from LL/SC and atomics:
+   sim -locks [sections] */
+int locksMain(int argc, char* argv[])
+{
+	return compareLocks((argc > 2) ? atoi(argv[2]) : 50) ? 0 : 1;
+}
+
+/* Run every configuration of a grid file on the programs:
+   sim -sweep grid.txt results.txt [prog1.asm prog2.asm prog3.asm prog4.asm] */
+int sweepMain(int argc, char* argv[], char* fileNames[])
+{
+	SweepGrid grid;
+	Program progs[NUM_CORES];
+	int i, status;
+
+	if (argc != 4 && argc != 4 + NUM_CORES)
+	{
+		fprintf(stderr, "Usage: %s -sweep grid.txt results.txt [prog1.asm ... prog%d.asm]\n", argv[0], NUM_CORES);
+		return 1;
+	}
+	if (argc == 4 + NUM_CORES)
+		fileNames = &argv[4];
+
+	if (!readSweepGrid(argv[2], &grid))
+		return 1;
+
+	for (i = 0; i < NUM_CORES; i++)
+		if ((progs[i] = loadProgram(fileNames[i])) == NULL)
+			return 1;
+
+	status = runSweep(&grid, progs, argv[3]);
+
+	for (i = 0; i < NUM_CORES; i++)
+		destroyProgram(progs[i]);
+
+	return status ? 0 : 1;
+}
+
+/* Run the programs and report how the cores share each line of memory:
+   sim -sharing [line_words] */
+int sharingMain(int argc, char* argv[], char* fileNames[])
+{
+	SimConfig config;
+	Computer comp;
+
+	getDefaultConfig(&config);
+	config.busTraceFileName = NULL;
+	config.sharingLineWords = (argc > 2) ? atoi(argv[2]) : 4;
+
+	comp = CreateNewComputer();
+	if (!initializeComputerWithConfig(comp, fileNames, &config))
+	{
+		destroyComputer(comp);
+		return 1;
+	}
+	runComputer(comp);
+	printSharingReport(comp->sharing, stdout, 20);
+	destroyComputer(comp);
+
+	return 0;
+}
+
+/* Run the programs and list the memory instructions costing the most cycles:
+   sim -hotspots [count] */
+int hotspotsMain(int argc, char* argv[], char* fileNames[])
+{
+	SimConfig config;
+	Computer comp;
+
+	getDefaultConfig(&config);
+	config.busTraceFileName = NULL;
+	config.pcProfile = True;
+
+	comp = CreateNewComputer();
+	if (!initializeComputerWithConfig(comp, fileNames, &config))
+	{
+		destroyComputer(comp);
+		return 1;
+	}
+	runComputer(comp);
+	printPCProfile(comp->pcProfile, stdout, (argc > 2) ? atoi(argv[2]) : 20);
+	destroyComputer(comp);
+
+	return 0;
+}
+
+/* Run the programs and print the miss ratio of every cache size, and of
+   every set count up to associativity ways when one is given:
+   sim -stackdist [associativity] */
+int stackDistanceMain(int argc, char* argv[], char* fileNames[])
+{
+	SimConfig config;
+	Computer comp;
+
+	getDefaultConfig(&config);
+	config.busTraceFileName = NULL;
+	config.stackDistance = True;
+	config.stackAssociativity = (argc > 2) ? atoi(argv[2]) : 0;
+
+	comp = CreateNewComputer();
+	if (!initializeComputerWithConfig(comp, fileNames, &config))
+	{
+		destroyComputer(comp);
+		return 1;
+	}
+	runComputer(comp);
+	printStackDistanceReport(comp->stackDistance, stdout);
+	destroyComputer(comp);
+
+	return 0;
+}
+
+// Read a comma separated list of values, returns the number read
+int readValueList(char* text, int values[], int maxValues)
+{
+	int n = 0;
+	char* token = strtok(text, ",");
+
+	for (; token != NULL && n < maxValues; token = strtok(NULL, ","))
+		values[n++] = atoi(token);
+
+	return n;
+}
+
+/* Run the programs with shadow caches of every combination of the sizes (in
+   blocks) and associativities, 16 to 4096 blocks of 1 to 8 ways by default:
+   sim -shadow [size,size,... [ways,ways,...]] */
+int shadowMain(int argc, char* argv[], char* fileNames[])
+{
+	int sizes[MAX_SHADOW_CACHES] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+	int associativities[MAX_SHADOW_CACHES] = { 1, 2, 4, 8 };
+	int numSizes = 9, numAssociativities = 4, hits = 0, misses = 0, i, j;
+	SimConfig config;
+	Computer comp;
+
+	if (argc > 2)
+		numSizes = readValueList(argv[2], sizes, MAX_SHADOW_CACHES);
+	if (argc > 3)
+		numAssociativities = readValueList(argv[3], associativities, MAX_SHADOW_CACHES);
+
+	getDefaultConfig(&config);
+	config.busTraceFileName = NULL;
+	for (i = 0; i < numSizes; i++)
+		for (j = 0; j < numAssociativities && config.numShadowCaches < MAX_SHADOW_CACHES; j++)
+			if (associativities[j] <= sizes[i])
+			{
+				config.shadowSizes[config.numShadowCaches] = sizes[i];
+				config.shadowAssociativities[config.numShadowCaches] = associativities[j];
+				config.numShadowCaches++;
+			}
+
+	comp = CreateNewComputer();
+	if (!initializeComputerWithConfig(comp, fileNames, &config))
+	{
+		destroyComputer(comp);
+		return 1;
+	}
+	runComputer(comp);
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		hits += comp->caches[i]->hits;
+		misses += comp->caches[i]->misses;
+	}
+	printf("Primary caches of %d blocks and %d ways: %d hits, %d misses\n",
+		config.cacheSize, config.associativity, hits, misses);
+	printShadowReport(comp->shadows, stdout);
+	destroyComputer(comp);
+
+	return 0;
+}
+
+/* Run the programs with plain MSI and with the migratory optimization and
+   compare the bus traffic:
+   sim -migratory */
+int migratoryMain(int argc, char* argv[], char* fileNames[])
+{
+	SimConfig config;
+	Computer comp;
+	int i;
+
+	getDefaultConfig(&config);
+	config.busTraceFileName = NULL;
+	for (i = 0; i < 2; i++)
+	{
+		config.migratoryOptimization = (i == 1);
+		comp = CreateNewComputer();
+		if (!initializeComputerWithConfig(comp, fileNames, &config))
+		{
+			destroyComputer(comp);
+			return 1;
+		}
+		runComputer(comp);
+		printf("%-10s cycles %d, BusRd %d, BusRdX %d, Flush %d\n", i ? "migratory" : "MSI", comp->totalCycles,
+			comp->bus->cmdCount[BusRd], comp->bus->cmdCount[BusRdx], comp->bus->cmdCount[Flush]);
+		if (i == 1)
+			printMigratoryReport(comp->bus, stdout);
+		destroyComputer(comp);
+	}
+
+	return 0;
+}
+
+/* Run the programs, writing statistics snapshots every interval cycles:
+   sim -stats stats.csv [interval]
+   A file name ending in .jsonl selects JSON lines instead of CSV. */
+int statsMain(int argc, char* argv[], char* fileNames[])
+{
+	SimConfig config;
+	Computer comp;
+	size_t length;
+	bool faulted;
+
+	if (argc != 3 && argc != 4)
+	{
+		fprintf(stderr, "Usage: %s -stats stats.csv [interval]\n", argv[0]);
+		return 1;
+	}
+
+	getDefaultConfig(&config);
+	config.busTraceFileName = NULL;
+	config.statsFileName = argv[2];
+	length = strlen(argv[2]);
+	if (length > 6 && strcmp(argv[2] + length - 6, ".jsonl") == 0)
+		config.statsFormat = StatsJSONLines;
+	if (argc == 4 && (config.statsInterval = atoi(argv[3])) <= 0)
+	{
+		fprintf(stderr, "Snapshot interval must be positive.\n");
+		return 1;
+	}
+
+	comp = CreateNewComputer();
+	if (!initializeComputerWithConfig(comp, fileNames, &config))
+	{
+		destroyComputer(comp);
+		return 1;
+	}
+	runComputer(comp);
+	printStatsRegistry(comp->stats, stdout);
+	faulted = hasComputerFaulted(comp);
+	destroyComputer(comp);
+
+	return faulted ? 1 : 0;
+}
+
+int main(int argc, char* argv[])
+{
+	char* fileNames[4] = { "prog1.asm", "prog2.asm", "prog3.asm", "prog4.asm" };
+
+	if (argc > 1 && strcmp(argv[1], "-sweep") == 0)
+		return sweepMain(argc, argv, fileNames);
+	if (argc > 1 && strcmp(argv[1], "-assemble") == 0)
+		return assembleMain(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "-bench-asm") == 0)
+		return benchAsmMain(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "-bench-sim") == 0)
+		return benchSimMain(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "-bench-ff") == 0)
+		return benchFunctionalMain(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "-generate") == 0)
+		return generateMain(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "-suite") == 0)
+		return suiteMain(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "-locks") == 0)
+		return locksMain(argc, argv);
+	if (argc > 1 && strcmp(argv[1], "-sharing") == 0)
+		return sharingMain(argc, argv, fileNames);
+	if (argc > 1 && strcmp(argv[1], "-hotspots") == 0)
+		return hotspotsMain(argc, argv, fileNames);
+	if (argc > 1 && strcmp(argv[1], "-stackdist") == 0)
+		return stackDistanceMain(argc, argv, fileNames);
+	if (argc > 1 && strcmp(argv[1], "-shadow") == 0)
+		return shadowMain(argc, argv, fileNames);
+	if (argc > 1 && strcmp(argv[1], "-migratory") == 0)
+		return migratoryMain(argc, argv, fileNames);
+	if (argc > 1 && strcmp(argv[1], "-stats") == 0)
+		return statsMain(argc, argv, fileNames);
+
+	Computer comp = CreateNewComputer();
+	if (!initializeComputer(comp, fileNames))
+		return 1;
+	runComputer(comp);
+	printStatsRegistry(comp->stats, stdout);
+	printCPIStacks(comp, stdout);
+	printLatencyReport(comp->bus, comp->stats, stdout);
+	bool faulted = hasComputerFaulted(comp);
+	destroyComputer(comp);
+	
+	return faulted ? 1 : 0;
+}
@@ -1,81 +1,101 @@
-#include "Shared.h"
-#include "Memory.h"
-
-Memory createNewMemory()
-{
-	Memory mem;
-
-	/* Create data memory */
-	mem = (Memory)malloc( sizeof(struct Memory_) );
-	if (mem == NULL)
-	{
-		fprintf(stderr, "Could not allocate data memory.\n");
-		return NULL;
-	}
-
-	mem->memBusy = False;
-	mem->memWaitCycles = 0;
-
-	return mem;
-}
-void freeMemory(Memory mem) 
-{
-	mem->memBusy = False;
-	mem->memWaitCycles = 0;
-	mem->curOp = NoMemOperation;
-}
-void destroyMemory( Memory mem)
-{
-	free(mem);
-}
-
-/* Start read operation on the memory */
-int readMemory(Memory mem, int address)
-{
-	if (mem->memBusy == True)
-		return 0;
-
-	mem->curOp = MemRead;
-	mem->curAddress = address;
-	mem->memBusy = True;
-	mem->memWaitCycles = MEM_LATENCY;
-
-	return 1;
-}
-
-/* Start read operation on the memory */
-int writeMemory(Memory mem, int address, int data)
-{
-	if (mem->memBusy == True)
-		return 0;
-
-	mem->curOp = MemWrite;
-	mem->curAddress = (unsigned int)address;
-	mem->curData = data;
-	mem->memBusy = True;
-	mem->memWaitCycles = MEM_LATENCY;
-
-	return 1;
-}
-
-MemStatus advanceMemoryClock(Memory mem)
-{
-	if (mem->memBusy == False || mem->memWaitCycles == 0)
-		return NoMemOperation;
-
-	mem->memWaitCycles--;
-	if (mem->memWaitCycles == 0)
-	{
-		switch (mem->curOp)
-		{
-			case MemWrite:
-				mem->data[mem->curAddress] = mem->curData;
-				return MemWriteFinished;
-			case MemRead:
-				mem->curData = mem->data[mem->curAddress];
-				return MemReadFinished;
-		}
-	}
-
-	return NoMemOperation;
-}
+#include <string.h>
+#include "Shared.h"
+#include "Memory.h"
+#include "Profile.h"
+
+Memory createNewMemory()
+{
+	return createNewMemoryWithLatency(MEM_LATENCY);
+}
+
+Memory createNewMemoryWithLatency(int latency)
+{
+	Memory mem;
+
+	/* Create data memory */
+	mem = (Memory)malloc( sizeof(struct Memory_) );
+	if (mem == NULL)
+	{
+		fprintf(stderr, "Could not allocate data memory.\n");
+		return NULL;
+	}
+
+	memset(mem->data, 0, sizeof(mem->data));
+	mem->memBusy = False;
+	mem->memWaitCycles = 0;
+	mem->latency = latency;
+	mem->reads = 0;
+	mem->writes = 0;
+
+	return mem;
+}
+void freeMemory(Memory mem) 
+{
+	mem->memBusy = False;
+	mem->memWaitCycles = 0;
+	mem->curOp = NoMemOperation;
+}
+void destroyMemory( Memory mem)
+{
+	free(mem);
+}
+
+/* Start read operation on the memory */
+int readMemory(Memory mem, int address)
+{
+	if (mem->memBusy == True)
+		return 0;
+
+	mem->reads++;
+	mem->curOp = MemRead;
+	mem->curAddress = address;
+	mem->memBusy = True;
+	mem->memWaitCycles = mem->latency;
+
+	return 1;
+}
+
+/* Start read operation on the memory */
+int writeMemory(Memory mem, int address, int data)
+{
+	if (mem->memBusy == True)
+		return 0;
+
+	mem->writes++;
+	mem->curOp = MemWrite;
+	mem->curAddress = (unsigned int)address;
+	mem->curData = data;
+	mem->memBusy = True;
+	mem->memWaitCycles = mem->latency;
+
+	return 1;
+}
+
+MemStatus advanceMemoryClock(Memory mem)
+{
+	PROFILE_SCOPE(ProfileMemoryClock);
+	if (mem->memBusy == False || mem->memWaitCycles == 0)
+		return NoMemOperation;
+
+	mem->memWaitCycles--;
+	if (mem->memWaitCycles == 0)
+	{
+		switch (mem->curOp)
+		{
+			case MemWrite:
+				mem->data[mem->curAddress] = mem->curData;
+				return MemWriteFinished;
+			case MemRead:
+				mem->curData = mem->data[mem->curAddress];
+				return MemReadFinished;
+		}
+	}
+
+	return NoMemOperation;
+}
+
+void registerMemoryStats(Memory mem, StatsRegistry reg)
+{
+	registerCounter(reg, "mem", "reads", &mem->reads);
+	registerCounter(reg, "mem", "writes", &mem->writes);
+}
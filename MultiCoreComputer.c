@@ -1,86 +1,373 @@
-#include "MultiCoreComputer.h"
-
-Computer CreateNewComputer()
-{
-	Computer comp = (Computer)malloc( sizeof(struct MultiCoreComputer) );
-
-	if (comp == NULL)
-	{
-		fprintf(stderr, "Could not allocate memory for computer.\n");
-		return NULL;
-	}
-
-	return comp;
-}
-
-void initializeComputer(Computer comp, char* fileNames[] )
-{
-	int i;
-
-	/* Create and initialize caches */
-	for (i = 0; i < NUM_CORES; i++)
-	{
-		/* Create and initialize cache i */
-		comp->caches[i] = getNewCache(i);
-	}
-
-	/* Create data memory */
-	comp->mem = createNewMemory();
-
-	/* Initialize MSI bus */
-	comp->bus = createMSIBus();
-	initializeMSIBus(comp->bus, comp->pipes, comp->caches, comp->mem);
-
-	/* Create and initialize pipelines */
-	for (i = 0; i < NUM_CORES; i++)
-	{		
-		/* Create and initialize pipeline i */
-		comp->pipes[i] = createPipeline();
-		initializePipeline(comp->pipes[i], fileNames[i], comp->bus, comp->caches[i] );
-	}	
-}
-
-void destroyComputer( Computer comp )
-{
-	int i;
-
-	for (i = 0; i < NUM_CORES; i++)
-	{
-		/* Create cache i */
-		destroyCache(comp->caches[i]);
-
-		/* Initialize pipeline i */
-		destroyPipeline(comp->pipes[i]);
-
-	}
-	/* Destroy data memory */
-	destroyMemory(comp->mem);
-
-	/* Destroy MSI bus */
-	destroyMSIBus(comp->bus);
-
-	/* Destroy computer */
-	free(comp);
-}
-
-void runComputer( Computer comp)
-{
-	int i;
-	MemStatus memStatus;
-	bool done = False;
-	int clockCnt = 0;
-
-	while (!done)
-	{
-		done = True;
-		for (i = 0; i < NUM_CORES; i++)
-			if (!comp->pipes[i]->totally_done)
-			{
-				done = False;
-				runPipelineOneCycle(comp->pipes[i]);
-			}
-		memStatus = advanceMemoryClock(comp->mem);
-		advanceMSIBusClock(comp->bus, memStatus);
-		clockCnt++;
-	}
-}
\ No newline at end of file
+#include "MultiCoreComputer.h"
+#include "Functional.h"
+#include "Profile.h"
+
+void getDefaultConfig(SimConfig* config)
+{
+	config->cacheSize = CACHE_SIZE;
+	config->associativity = ASSOCIATIVITY;
+	config->memLatency = MEM_LATENCY;
+	config->maxCycles = 0;
+	config->forwarding = True;
+	config->predictor = PredictBimodal;
+	config->issueWidth = 1;
+	config->cachePorts = 1;
+	config->memoryModel = SequentialConsistency;
+	config->fastForward = 0;
+	config->fastForwardMarker = -1;
+	config->warmCaches = True;
+	config->busTraceFileName = "bustrace.txt";
+	config->statsFileName = NULL;
+	config->statsFormat = StatsCSV;
+	config->statsInterval = 1000;
+	config->sharingLineWords = 0;
+	config->migratoryOptimization = False;
+	config->pcProfile = False;
+	config->stackDistance = False;
+	config->stackAssociativity = 0;
+	config->numShadowCaches = 0;
+}
+
+Computer CreateNewComputer()
+{
+	Computer comp = (Computer)calloc( 1, sizeof(struct MultiCoreComputer) );
+
+	if (comp == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for computer.\n");
+		return NULL;
+	}
+
+	return comp;
+}
+
+int initializeComputer(Computer comp, char* fileNames[] )
+{
+	SimConfig config;
+
+	getDefaultConfig(&config);
+	return initializeComputerWithConfig(comp, fileNames, &config);
+}
+
+int initializeComputerWithConfig(Computer comp, char* fileNames[], const SimConfig* config)
+{
+	int i, j;
+	Program progs[NUM_CORES];
+
+	/* Parse the programs */
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		progs[i] = loadProgram(fileNames[i]);
+		if (progs[i] == NULL)
+		{
+			for (j = 0; j < i; j++)
+				destroyProgram(progs[j]);
+			return 0;
+		}
+	}
+
+	if (!initializeComputerWithPrograms(comp, progs, config))
+	{
+		for (i = 0; i < NUM_CORES; i++)
+			destroyProgram(progs[i]);
+		return 0;
+	}
+	comp->ownsPrograms = True;
+
+	return 1;
+}
+
+int initializeComputerWithPrograms(Computer comp, Program progs[], const SimConfig* config)
+{
+	int i;
+
+	comp->config = *config;
+	comp->ownsPrograms = False;
+	comp->totalCycles = 0;
+
+	if (config->issueWidth < 1 || config->issueWidth > 2 || config->cachePorts < 1 || config->cachePorts > 2)
+	{
+		fprintf(stderr, "Issue width and cache ports must be 1 or 2.\n");
+		return 0;
+	}
+	if (config->predictor < 0 || config->predictor >= NumPredictorSchemes)
+	{
+		fprintf(stderr, "Unknown branch predictor %d.\n", config->predictor);
+		return 0;
+	}
+	if (config->memoryModel < 0 || config->memoryModel >= NumMemoryModels)
+	{
+		fprintf(stderr, "Unknown memory model %d.\n", config->memoryModel);
+		return 0;
+	}
+
+	/* Create and initialize caches */
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		/* Create and initialize cache i */
+		comp->caches[i] = getNewCacheWithGeometry(i, config->cacheSize, config->associativity);
+		if (comp->caches[i] == NULL)
+			return 0;
+		comp->caches[i]->ports = config->cachePorts;
+	}
+
+	/* Create data memory */
+	comp->mem = createNewMemoryWithLatency(config->memLatency);
+	if (comp->mem == NULL)
+		return 0;
+
+	/* Create pipelines, the bus keeps them to release frozen cores */
+	for (i = 0; i < NUM_CORES; i++)
+		if ((comp->pipes[i] = createPipeline()) == NULL)
+			return 0;
+
+	/* Initialize MSI bus */
+	comp->bus = createMSIBus();
+	if (comp->bus == NULL)
+		return 0;
+	if (!initializeMSIBus(comp->bus, comp->pipes, comp->caches, comp->mem, config->busTraceFileName))
+		return 0;
+	if (config->migratoryOptimization && !enableMigratoryOptimization(comp->bus))
+		return 0;
+
+	/* Initialize pipelines */
+	for (i = 0; i < NUM_CORES; i++)
+	{		
+		/* Initialize pipeline i */
+		comp->progs[i] = progs[i];
+		initializePipeline(comp->pipes[i], progs[i], comp->bus, comp->caches[i] );
+		comp->pipes[i]->forwarding = config->forwarding;
+		comp->pipes[i]->issueWidth = config->issueWidth;
+		if (config->predictor != PredictNotTaken &&
+			(comp->pipes[i]->predictor = createBranchPredictor(config->predictor)) == NULL)
+			return 0;
+		if (config->memoryModel == TotalStoreOrder &&
+			(comp->pipes[i]->storeBuffer = createStoreBuffer()) == NULL)
+			return 0;
+	}	
+
+	if (config->sharingLineWords > 0)
+	{
+		if ((comp->sharing = createSharingTracker(config->sharingLineWords)) == NULL)
+			return 0;
+		for (i = 0; i < NUM_CORES; i++)
+			comp->pipes[i]->sharing = comp->sharing;
+	}
+
+	if (config->pcProfile)
+	{
+		if ((comp->pcProfile = createPCProfile(comp->progs)) == NULL)
+			return 0;
+		for (i = 0; i < NUM_CORES; i++)
+			comp->pipes[i]->pcProfile = comp->pcProfile;
+	}
+
+	if (config->stackDistance)
+	{
+		if ((comp->stackDistance = createStackDistance(config->stackAssociativity)) == NULL)
+			return 0;
+		for (i = 0; i < NUM_CORES; i++)
+			comp->pipes[i]->stackDistance = comp->stackDistance;
+	}
+
+	if (config->numShadowCaches > 0)
+	{
+		comp->shadows = createShadowBank(config->shadowSizes, config->shadowAssociativities, config->numShadowCaches);
+		if (comp->shadows == NULL)
+			return 0;
+		for (i = 0; i < NUM_CORES; i++)
+			comp->pipes[i]->shadows = comp->shadows;
+	}
+
+	if ((comp->stats = createStatsRegistry()) == NULL)
+		return 0;
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		char prefix[16];
+
+		sprintf(prefix, "core%d", i);
+		registerPipelineStats(comp->pipes[i], comp->stats, prefix);
+		sprintf(prefix, "cache%d", i);
+		registerCacheStats(comp->caches[i], comp->stats, prefix);
+	}
+	registerCounter(comp->stats, "computer", "cycles", &comp->totalCycles);
+	registerBusStats(comp->bus, comp->stats);
+	registerMemoryStats(comp->mem, comp->stats);
+	if (comp->shadows != NULL)
+		registerShadowStats(comp->shadows, comp->stats);
+	if (config->statsFileName != NULL &&
+		!openStatsOutput(comp->stats, config->statsFileName, config->statsFormat, config->statsInterval))
+		return 0;
+
+	if (config->fastForward > 0 || config->fastForwardMarker >= 0)
+		fastForwardComputer(comp, config->fastForward, config->fastForwardMarker, config->warmCaches);
+
+	return 1;
+}
+
+void destroyComputer( Computer comp )
+{
+	int i;
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		/* Create cache i */
+		destroyCache(comp->caches[i]);
+
+		/* Initialize pipeline i */
+		destroyPipeline(comp->pipes[i]);
+
+		if (comp->ownsPrograms)
+			destroyProgram(comp->progs[i]);
+	}
+	/* Destroy data memory */
+	destroyMemory(comp->mem);
+
+	/* Destroy MSI bus */
+	destroyMSIBus(comp->bus);
+
+	destroyStatsRegistry(comp->stats);
+	destroySharingTracker(comp->sharing);
+	destroyPCProfile(comp->pcProfile);
+	destroyStackDistance(comp->stackDistance);
+	destroyShadowBank(comp->shadows);
+
+	/* Destroy computer */
+	free(comp);
+}
+
+void handleStatsControls(Computer comp)
+{
+	Pipeline* pipe;
+	int i, j;
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		pipe = comp->pipes[i];
+		for (j = 0; j < pipe->numStatsControls; j++)
+			switch (pipe->statsControls[j])
+			{
+			case ROI_BEGIN:
+				if (comp->roi == RoiClosed)
+					break;      // One region per run, until stats_reset
+				if (comp->roi == RoiNotStarted)
+				{
+					resetStats(comp->stats);
+					comp->roi = RoiOpen;
+				}
+				comp->roiCores |= 1 << i;
+				break;
+			case ROI_END:
+				comp->roiCores &= ~(1 << i);
+				if (comp->roi == RoiOpen && comp->roiCores == 0)
+				{
+					freezeStats(comp->stats);
+					writeStatsSnapshot(comp->stats, comp->totalCycles);
+					comp->roi = RoiClosed;
+				}
+				break;
+			case STATS_RESET:
+				resetStats(comp->stats);
+				if (comp->roi == RoiClosed)
+					comp->roi = RoiNotStarted;
+				break;
+			case STATS_DUMP:
+				if (comp->stats->out != NULL)
+					dumpStatsSnapshot(comp->stats, comp->totalCycles);
+				else
+				{
+					printf("Statistics dumped by core %d at cycle %d\n", i, comp->totalCycles);
+					printStatsRegistry(comp->stats, stdout);
+				}
+				break;
+			default:
+				break;
+			}
+		pipe->numStatsControls = 0;
+	}
+}
+
+// Run one clock cycle of the cores, memory and bus.
+// Returns True when all cores have halted.
+bool runComputerOneCycle( Computer comp )
+{
+	int i;
+	MemStatus memStatus;
+	bool done = True;
+	PROFILE_SCOPE(ProfileRunComputer);
+
+	for (i = 0; i < NUM_CORES; i++)
+		if (!comp->pipes[i]->totally_done)
+		{
+			done = False;
+			runPipelineOneCycle(comp->pipes[i]);
+		}
+	if (done)
+	{
+		writeStatsSnapshot(comp->stats, comp->totalCycles);
+		return True;
+	}
+
+	for (i = 0; i < NUM_CORES; i++)
+		if (comp->pipes[i]->totally_done)
+			comp->pipes[i]->cycleBuckets[CycleHalted]++;
+
+	memStatus = advanceMemoryClock(comp->mem);
+	advanceMSIBusClock(comp->bus, memStatus);
+	comp->totalCycles++;
+	PROFILE_CYCLES(1);
+	// After the whole cycle is counted, so a reset starts the region at the next one
+	handleStatsControls(comp);
+	sampleStats(comp->stats, comp->totalCycles);
+
+	return False;
+}
+
+void runComputer( Computer comp)
+{
+	while (!runComputerOneCycle(comp))
+	{
+		// runComputerOneCycle only writes the last snapshot when the cores halt
+		if (comp->config.maxCycles > 0 && comp->totalCycles >= comp->config.maxCycles)
+		{
+			writeStatsSnapshot(comp->stats, comp->totalCycles);
+			break;
+		}
+	}
+}
+
+bool hasComputerFaulted(Computer comp)
+{
+	int i;
+
+	for (i = 0; i < NUM_CORES; i++)
+		if (comp->pipes[i]->faulted)
+			return True;
+	return False;
+}
+
+void printCPIStacks(Computer comp, FILE* out)
+{
+	int buckets[NumCycleBuckets] = { 0 };
+	int core[NumCycleBuckets];
+	int i, j, cycles, coreInstructions, instructions = 0, systemCycles = 0;
+	char name[16];
+
+	// Through the registry, so the stacks cover the region of interest
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		sprintf(name, "core%d", i);
+		cycles = 0;
+		for (j = 0; j < NumCycleBuckets; j++)
+		{
+			core[j] = readRegisteredCounter(comp->stats, &comp->pipes[i]->cycleBuckets[j]);
+			cycles += core[j];
+			buckets[j] += core[j];
+		}
+		coreInstructions = readRegisteredCounter(comp->stats, &comp->pipes[i]->wbUtil);
+		printCPIStack(out, name, core, cycles, coreInstructions);
+		instructions += coreInstructions;
+		systemCycles += cycles;
+	}
+	printCPIStack(out, "the system", buckets, systemCycles, instructions);
+}
@@ -1,23 +1,83 @@
-#ifndef MULTI_CORE_COMPUTER_H
-#define MULTI_CORE_COMPUTER_H
-
-#include "Shared.h"
-#include "Pipeline2.h"
-#include "Cache.h"
-#include "MSIBus.h"
-
-struct MultiCoreComputer
-{
-	Pipeline* pipes[NUM_CORES];
-	Cache caches[NUM_CORES];
-	MSIBus bus;
-	Memory mem;
-};
-typedef struct MultiCoreComputer* Computer;
-
-Computer CreateNewComputer();
-void initializeComputer(Computer comp, char* fileNames[]);
-void destroyComputer(Computer comp);
-void runComputer(Computer comp);
-
-#endif
\ No newline at end of file
+#ifndef MULTI_CORE_COMPUTER_H
+#define MULTI_CORE_COMPUTER_H
+
+#include "Shared.h"
+#include "Pipeline2.h"
+#include "Cache.h"
+#include "MSIBus.h"
+#include "Sharing.h"
+#include "PCProfile.h"
+
+/* Parameters of one simulated computer */
+typedef struct
+{
+	int cacheSize;          /* Cache size in words */
+	int associativity;      /* Blocks per cache set, 1 = direct mapped */
+	int memLatency;         /* Main memory latency in cycles */
+	int maxCycles;          /* Stop after this many cycles, 0 = run until all cores halt */
+	bool forwarding;        /* Bypass network in the pipelines, False stalls every hazard until write back */
+	PredictorScheme predictor; /* Branch prediction in IF */
+	int issueWidth;         /* 1, or 2 for in-order dual issue */
+	int cachePorts;         /* Data cache ports, memory operations a dual-issue pair may hold */
+	MemoryModel memoryModel; /* TotalStoreOrder retires stores into a store buffer per core */
+	int fastForward;        /* Instructions each core executes functionally before the detailed run, 0 = none */
+	int fastForwardMarker;  /* Or address at which a core stops fast-forwarding, -1 = none */
+	bool warmCaches;        /* Fast-forwarding fills the caches and their MSI states */
+	char* busTraceFileName; /* NULL runs without a bus trace */
+	char* statsFileName;    /* Statistics snapshots, NULL writes none */
+	StatsFormat statsFormat;
+	int statsInterval;      /* Cycles between snapshots, a last one is written when all cores halt */
+	int sharingLineWords;   /* Words per line of the sharing analysis, 0 = no analysis */
+	bool migratoryOptimization; /* Reads of lines detected migratory take them exclusively */
+	bool pcProfile;         /* Count misses and frozen cycles per instruction */
+	bool stackDistance;     /* Miss ratio curves of every cache size from the reference streams */
+	int stackAssociativity; /* Also the set-associative curves up to this many ways, 0 = none */
+	int numShadowCaches;    /* Geometries looked up next to the primary caches, 0 = none */
+	int shadowSizes[MAX_SHADOW_CACHES];          /* In blocks */
+	int shadowAssociativities[MAX_SHADOW_CACHES];
+} SimConfig;
+
+/* Region of interest: the statistics restart when the first core writes
+   back roi_begin and freeze when every core that began it wrote back roi_end.
+   Later roi_begins are ignored until a stats_reset. */
+typedef enum { RoiNotStarted = 0, RoiOpen, RoiClosed } RoiState;
+
+struct MultiCoreComputer
+{
+	Pipeline* pipes[NUM_CORES];
+	Cache caches[NUM_CORES];
+	MSIBus bus;
+	Memory mem;
+	Program progs[NUM_CORES];
+	bool ownsPrograms;      /* Programs were loaded by the computer and are destroyed with it */
+	SimConfig config;
+	StatsRegistry stats;    /* Counters of every module */
+	SharingTracker sharing; /* Sharing analysis, NULL when off */
+	PCProfile pcProfile;    /* Memory profile per instruction, NULL when off */
+	StackDistance stackDistance; /* Stack distance analysis, NULL when off */
+	ShadowBank shadows;     /* Shadow caches, NULL when off */
+	RoiState roi;
+	int roiCores;           /* Cores inside the region of interest, a bit each */
+	int totalCycles;
+};
+typedef struct MultiCoreComputer* Computer;
+
+void getDefaultConfig(SimConfig* config);
+Computer CreateNewComputer();
+int initializeComputer(Computer comp, char* fileNames[]);
+int initializeComputerWithConfig(Computer comp, char* fileNames[], const SimConfig* config);
+// Build the computer from already parsed programs, which are only read and
+// may be shared by many computers
+int initializeComputerWithPrograms(Computer comp, Program progs[], const SimConfig* config);
+// Destroy a computer, also when its initialization failed part way
+void destroyComputer(Computer comp);
+// Apply the statistics control instructions the cores wrote back this cycle
+void handleStatsControls(Computer comp);
+void runComputer(Computer comp);
+bool runComputerOneCycle(Computer comp);
+// True when a core stopped on an invalid instruction, so the run failed
+bool hasComputerFaulted(Computer comp);
+// Print the CPI stack of every core and of the whole computer since the last statistics reset
+void printCPIStacks(Computer comp, FILE* out);
+
+#endif
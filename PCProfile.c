@@ -0,0 +1,109 @@
+#include <string.h>
+#include "PCProfile.h"
+#include "Assembler.h"
+
+#define MAX_DISASSEMBLY 64
+
+PCProfile createPCProfile(Program progs[])
+{
+	PCProfile profile;
+	int i;
+
+	if ((profile = (PCProfile)calloc(1, sizeof(struct PCProfile_))) == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for the PC profile.\n");
+		return NULL;
+	}
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		profile->progs[i] = progs[i];
+		profile->entries[i] = (PCProfileEntry*)calloc(progs[i]->numInstructions + 1, sizeof(PCProfileEntry));
+		if (profile->entries[i] == NULL)
+		{
+			fprintf(stderr, "Could not allocate memory for the PC profile.\n");
+			destroyPCProfile(profile);
+			return NULL;
+		}
+	}
+	return profile;
+}
+
+void destroyPCProfile(PCProfile profile)
+{
+	int i;
+
+	if (profile == NULL)
+		return;
+
+	for (i = 0; i < NUM_CORES; i++)
+		free(profile->entries[i]);
+	free(profile);
+}
+
+PCProfileEntry* getPCProfileEntry(PCProfile profile, int core, int pc)
+{
+	if (pc < 0 || pc >= profile->progs[core]->numInstructions)
+		return NULL;
+	return &profile->entries[core][pc];
+}
+
+/* Instruction of the report */
+typedef struct
+{
+	int core;
+	int pc;
+	const PCProfileEntry* entry;
+} PCProfileRow;
+
+// Order of the report, most frozen cycles first, then most misses
+int comparePCProfileRows(const void* a, const void* b)
+{
+	const PCProfileRow* x = (const PCProfileRow*)a;
+	const PCProfileRow* y = (const PCProfileRow*)b;
+
+	if (x->entry->frozenCycles != y->entry->frozenCycles)
+		return y->entry->frozenCycles - x->entry->frozenCycles;
+	if (x->entry->misses != y->entry->misses)
+		return y->entry->misses - x->entry->misses;
+	if (x->core != y->core)
+		return x->core - y->core;
+	return x->pc - y->pc;
+}
+
+void printPCProfile(PCProfile profile, FILE* out, int maxEntries)
+{
+	char text[MAX_DISASSEMBLY];
+	PCProfileRow* rows;
+	PCProfileEntry* entry;
+	int core, pc, i, numRows = 0, total = 0;
+
+	for (core = 0; core < NUM_CORES; core++)
+		total += profile->progs[core]->numInstructions;
+	if ((rows = (PCProfileRow*)malloc((total + 1) * sizeof(PCProfileRow))) == NULL)
+		return;
+
+	for (core = 0; core < NUM_CORES; core++)
+		for (pc = 0; pc < profile->progs[core]->numInstructions; pc++)
+		{
+			entry = &profile->entries[core][pc];
+			if (entry->accesses + entry->misses + entry->scFailures + entry->frozenCycles == 0)
+				continue;
+			rows[numRows].core = core;
+			rows[numRows].pc = pc;
+			rows[numRows].entry = entry;
+			numRows++;
+		}
+	qsort(rows, numRows, sizeof(PCProfileRow), comparePCProfileRows);
+
+	fprintf(out, "Instructions by frozen cycles in MEM, %d of %d\n", (numRows < maxEntries) ? numRows : maxEntries, numRows);
+	fprintf(out, "%4s %5s %9s %8s %10s %8s %9s  %s\n", "core", "pc", "accesses", "misses", "coherence", "sc-fail",
+		"frozen", "instruction");
+	for (i = 0; i < numRows && i < maxEntries; i++)
+	{
+		disassembleInstruction(&profile->progs[rows[i].core]->instructions[rows[i].pc], text, MAX_DISASSEMBLY);
+		fprintf(out, "%4d %5d %9d %8d %10d %8d %9d  %s\n", rows[i].core, rows[i].pc, rows[i].entry->accesses,
+			rows[i].entry->misses, rows[i].entry->coherenceMisses, rows[i].entry->scFailures,
+			rows[i].entry->frozenCycles, text);
+	}
+	free(rows);
+}
@@ -0,0 +1,44 @@
+#ifndef PC_PROFILE_H
+#define PC_PROFILE_H
+
+#include "Shared.h"
+#include "Pipeline2.h"
+
+/* Memory profile per instruction
+ *
+ * Every LW, SW, LL and SC reaching MEM is counted against the core and PC of
+ * the instruction: completed accesses, misses sent to the bus, the misses of
+ * those to a block another core invalidated, failed SCs, and the cycles MEM
+ * stayed frozen on it waiting for the bus or the store buffer. Stores
+ * retired into a store buffer miss after they left MEM, so their misses are
+ * not counted. The report lists the instructions with the most frozen
+ * cycles next to their disassembly.
+ */
+
+typedef struct
+{
+	int accesses;
+	int misses;
+	int coherenceMisses;    /* Misses of a block another core invalidated */
+	int scFailures;
+	int frozenCycles;
+} PCProfileEntry;
+
+struct PCProfile_
+{
+	Program progs[NUM_CORES];
+	PCProfileEntry* entries[NUM_CORES];     /* One per instruction of the core's program */
+};
+typedef struct PCProfile_* PCProfile;
+
+// The programs must outlive the profile, NULL when out of memory
+PCProfile createPCProfile(Program progs[]);
+void destroyPCProfile(PCProfile profile);
+
+// Entry of the instruction at pc, NULL outside the core's program
+PCProfileEntry* getPCProfileEntry(PCProfile profile, int core, int pc);
+
+// Print the maxEntries instructions with the most frozen cycles, then misses
+void printPCProfile(PCProfile profile, FILE* out, int maxEntries);
+
+#endif
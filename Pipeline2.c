@@ -1,931 +1,1256 @@
-#include <stdio.h>
-#include <assert.h>
-#include <stdlib.h>
-#include <string.h>
-#include <ctype.h>
-
-#include "Pipeline2.h"
-
-Instruction bubble = { S, STALL, 0, 0, 0, False };
-
-Pipeline* createPipeline()
-{
-	Pipeline *pipe = (Pipeline *) malloc(sizeof(Pipeline));
-	return pipe;
-}
-
-void destroyPipeline(Pipeline* pipe)
-{
-	free(pipe);
-}
-
-void initializePipeline( Pipeline *pipe, char* fileName, struct MSIBus_ *bus, Cache cache )
-{
-	int i;
-
-	for (i = 0; i < NumStages; i++)
-	{				
-		pipe->stageStat[i].stalled = False;
-		pipe->stageStat[i].stallNextCycle = False;
-		pipe->stageStat[i].delayedWrite = False;
-		pipe->stageInst[i].inst = bubble;
-	}
-
-	pipe->dataHazardStallCycles = 0;
-	pipe->stalledDataHazard = False;
-	pipe->flushBranchFlag = False;
-	pipe->branchTaken = False;
-	pipe->totally_done = False;      // True when halt has propagated through the pipeline
-	pipe->interactive_mode = False;  // If True, print registers after each Instruction, wait for enter to be pressed
-
-
-	pipe->registers[0] = 0;
-	pipe->PC = 0;
-	pipe->haltIndex = 0;
-	pipe->totalCycles = 0;
-	pipe->ifUtil = 0;
-	pipe->idUtil = 0;
-	pipe->exUtil = 0;
-	pipe->memUtil = 0;
-	pipe->wbUtil = 0;
-
-	pipe->bus = bus;
-	pipe->cache = cache;
-
-	progScanner(pipe, fileName);
-}
-
-void runPipelineOneCycle(Pipeline* pipe)
-{
-	char blank[2];
-
-	WB(pipe);
-	if (pipe->totally_done) // Case of HALT processed
-		return;
-
-	MEM(pipe);
-	EX(pipe);
-	ID(pipe);
-	IF(pipe);
-	pipe->totalCycles++;
-	if (pipe->interactive_mode)
-	{
-		printRegisters(pipe);
-		printStatistics(pipe);
-		printf("Press ENTER to continue.\n");
-		fgets(blank, sizeof(blank), stdin);
-	}
-}
-
-void runPipelineFully( Pipeline* pipe )
-{	
-	// Then start iterating over the pipelined stages in reverse
-	while (!pipe->totally_done)
-		runPipelineOneCycle(pipe);
-
-	printStatistics(pipe);
-	printRegisters (pipe);
-}
-
-void progScanner(Pipeline* pipe, char* filename)
-{
-	char instruction_string[MAX_INSTR_LEN];
-	FILE* instFile = fopen(filename, "r");
-	
-	if (instFile == NULL) 
-		assert(!"Invalid file");
-
-	while ( fgets(instruction_string, MAX_INSTR_LEN, instFile) )
-		parser(pipe, instruction_string);
-
-	fclose(instFile);
-}
-
-void parser(Pipeline* pipe, char* inst)
-{
-	int rs, rd, rt, imm;
-	int PC = pipe->PC;
-	opcode op;
-	char* opString;
-
-	trimInstruction(inst);
-	// To hold haltSimultion, needs 15 chars
-	opString = extractOpcode(inst);
-	op = stringToOpcode(opString);
-
-	if ( isRegularType(op) ) 
-	{
-		rs = extractRegister(inst, 1);
-		rt = extractRegister(inst, 2);
-		rd = extractRegister(inst, 0);
-		pipe->instruction_mem[PC].type = Reg;
-		pipe->instruction_mem[PC].op = op;
-		pipe->instruction_mem[PC].rs = rs;
-		pipe->instruction_mem[PC].rt = rt;
-		pipe->instruction_mem[PC].rd = rd;
-		if (rt == -1)
-		{			
-			imm = extractImmediate(inst, 2);
-			pipe->instruction_mem[PC].imm = imm;
-			pipe->instruction_mem[PC].hasImm = True;
-		}
-		else
-		{
-			pipe->instruction_mem[PC].imm = -1;
-			pipe->instruction_mem[PC].hasImm = False;
-		}		
-		pipe->instruction_mem[PC].isHalt = False;
-	}	
-	else if ( isJal(op) )
-	{		
-		imm = extractImmediate(inst, 0);
-		pipe->instruction_mem[PC].type = J;
-		pipe->instruction_mem[PC].op = op;
-		pipe->instruction_mem[PC].rs = -1;
-		pipe->instruction_mem[PC].rt = -1;
-		pipe->instruction_mem[PC].rd = 1;  // Register 1
-		pipe->instruction_mem[PC].imm = imm;
-		pipe->instruction_mem[PC].hasImm = True;
-		pipe->instruction_mem[PC].isHalt = False;
-	}	
-	else if ( isBranch(op) )
-	{
-		rs = extractRegister(inst, 1);
-		rt = extractRegister(inst, 2);
-		imm = extractImmediate(inst, 3);
-		pipe->instruction_mem[PC].type = B;
-		pipe->instruction_mem[PC].op = op;
-		pipe->instruction_mem[PC].rs = rs;
-		pipe->instruction_mem[PC].rt = rt;
-		pipe->instruction_mem[PC].rd = 1; // Register 1
-		pipe->instruction_mem[PC].imm = imm;
-		pipe->instruction_mem[PC].hasImm = True;
-		pipe->instruction_mem[PC].isHalt = False;
-	}
-	else if ( isStore(op) )
-	{
-		rs = extractRegister(inst, 1);
-		rt = extractRegister(inst, 2);
-		rd = extractRegister(inst, 0);
-		pipe->instruction_mem[PC].type = STR;
-		pipe->instruction_mem[PC].op = op;
-		pipe->instruction_mem[PC].rs = rs;
-		pipe->instruction_mem[PC].rt = rt;
-		pipe->instruction_mem[PC].rd = rd;
-		pipe->instruction_mem[PC].hasImm = False;
-		pipe->instruction_mem[PC].isHalt = False;
-	}
-	else if ( isHalt(op) ) 
-	{
-		// Run the halt Instruction through the pipeline and then stop
-		pipe->instruction_mem[PC].type = H;
-		pipe->instruction_mem[PC].op = HALT;
-		pipe->instruction_mem[PC].rs = -1;
-		pipe->instruction_mem[PC].rt = -1;
-		pipe->instruction_mem[PC].rd = -1;		
-		pipe->instruction_mem[PC].isHalt = True;
-		pipe->instruction_mem[PC].hasImm = False;
-		pipe->haltIndex = PC;
-	}
-	else
-		assert(!"Illegal opcode");
-
-	pipe->PC++;
-}
-
-void IF( Pipeline* pipe )
-{		
-	if ( pipe->stageStat[IFStage].stalled == False && pipe->stalledDataHazard == False )
-	{		
-		if ( pipe->branchTaken ) // Flush when branch taken
-		{
-			if (pipe->flushBranchFlag)
-			{
-				pipe->stageInst[IFStage].inst = bubble;
-				pipe->branchTaken = False;
-			}
-		}
-		else
-		{
-			pipe->stageInst[IFStage].inst = pipe->instruction_mem[pipe->PC];
-			if (pipe->PC < pipe->haltIndex)
-				pipe->PC++;
-		}	
-		
-		if (pipe->stageInst[IFStage].inst.type != S)
-			pipe->ifUtil++;
-
-		// Pass the Instruction to the next Stage
-		pipe->stageInst[IDStage].inst = pipe->stageInst[IFStage].inst;
-	}
-
-	if (pipe->stageStat[IFStage].stallNextCycle)
-	{
-		pipe->stageStat[IFStage].stalled = True;  // Stall next cycle
-		pipe->stageStat[IFStage].stallNextCycle = False;
-	}
-	
-}
-
-void ID( Pipeline* pipe )
-{	
-	int rs, rt, rd;	
-	pipe->branchTaken = False;
-	Stage dataHazardStage;
-
-	if (pipe->stalledDataHazard && pipe->dataHazardStallCycles == 0) // finished waiting for data hazard resolution
-		pipe->stalledDataHazard = False;
-
-	if (pipe->stageStat[IDStage].stalled == False && pipe->stalledDataHazard == False )
-	{		
-		if (pipe->stageInst[IDStage].inst.type != S)
-			pipe->idUtil++;
-
-		//If there's no hazard
-		if ( checkHazard(pipe) < 0 ) 
-		{
-			rs = pipe->stageInst[IDStage].inst.rs;
-			rt = pipe->stageInst[IDStage].inst.rt;
-			rd = pipe->stageInst[IDStage].inst.rd;
-
-			if ( rs > NUM_REGS - 1 || rt > NUM_REGS - 1 || rd > NUM_REGS - 1 ||
-				 rs < 0 || rt < 0 || rd < 0 )
-				assert(!"Invalid register location");
-
-			if ( rd == 1 && pipe->stageInst[IDStage].inst.type != B && pipe->stageInst[IDStage].inst.type != J)
-				assert(!"Destination register cannot be R1");
-
-			// Place immediate in rdData
-			if ( pipe->stageInst[IDStage].inst.type == B || pipe->stageInst[IDStage].inst.type == J )
-				pipe->stageInst[IDStage].inst.rdData = pipe->stageInst[IDStage].inst.imm;
-
-			// If it's a branch, check if it is taken
-			if (pipe->stageInst[IDStage].inst.op == BEQ)
-			{
-				if (pipe->registers[rs] == pipe->registers[rt]) // taken
-				{
-					pipe->PC = pipe->stageInst[IDStage].inst.rdData & 0x3FF;
-					pipe->branchTaken = True;
-				}
-			}
-			else if (pipe->stageInst[IDStage].inst.op == BNE)
-			{
-				if (pipe->registers[rs] != pipe->registers[rt]) // taken
-				{
-					pipe->PC = pipe->stageInst[IDStage].inst.rdData & 0x3FF;
-					pipe->branchTaken = True;
-				}
-			}
-			else if (pipe->stageInst[IDStage].inst.op == BLT)
-			{
-				if (pipe->registers[rs] < pipe->registers[rt]) // taken
-				{
-					pipe->PC = pipe->stageInst[IDStage].inst.rdData & 0x3FF;
-					pipe->branchTaken = True;
-				}
-			}
-			else if (pipe->stageInst[IDStage].inst.op == BGT)
-			{
-				if (pipe->registers[rs] > pipe->registers[rt]) // taken
-				{
-					pipe->PC = pipe->stageInst[IDStage].inst.rdData & 0x3FF;
-					pipe->branchTaken = True;
-				}
-			}
-			else if (pipe->stageInst[IDStage].inst.op == BLE)
-			{
-				if (pipe->registers[rs] <= pipe->registers[rt]) // taken
-				{
-					pipe->PC = pipe->stageInst[IDStage].inst.rdData & 0x3FF;
-					pipe->branchTaken = True;
-				}
-			}
-			else if (pipe->stageInst[IDStage].inst.op == BGE)
-			{
-				if (pipe->registers[rs] >= pipe->registers[rt]) // taken
-				{
-					pipe->PC = pipe->stageInst[IDStage].inst.rdData & 0x3FF;
-					pipe->branchTaken = True;
-				}
-			}
-			else if (pipe->stageInst[IDStage].inst.op == JAL)
-			{
-				pipe->stageInst[IDStage].data = pipe->PC + 1;
-				pipe->PC = pipe->stageInst[IDStage].inst.rdData & 0x3FF;				
-			}
-
-			// Read the registers
-			if ( rs != -1 )
-				pipe->stageInst[IDStage].inst.rsData = pipe->registers[rs];
-			if ( rt != -1 )
-				pipe->stageInst[IDStage].inst.rtData = pipe->registers[rt];
-			if ( rd != -1 )
-				pipe->stageInst[IDStage].inst.rdData = pipe->registers[rd];
-
-			// Pass the Instruction to the next Stage
-			pipe->stageInst[EXStage].inst = pipe->stageInst[IDStage].inst;
-				
-		}
-		else // Insert bubble to EX Stage and stall IF and ID
-		{						
-			//pipe->stageStat[IFStage].stalled = True;
-			//pipe->stageStat[IDStage].stalled = True;
-			pipe->stageInst[EXStage].inst = bubble;
-			pipe->dataHazardStallCycles--;
-		}
-	}
-	
-	
-	if (pipe->stalledDataHazard == True)
-	{
-		dataHazardStage = NumStages - pipe->dataHazardStallCycles;
-		if ( pipe->stageStat[ dataHazardStage ].stalled == False ) // Check that the instruction resolving the data hazard is not stalled
-			pipe->dataHazardStallCycles--; // counter for data hazard resolution
-	}
-
-	if (pipe->stageStat[IDStage].stallNextCycle)
-	{
-		pipe->stageStat[IDStage].stalled = True;  // Stall next cycle
-		pipe->stageStat[IDStage].stallNextCycle = False;
-	}
-}
-
-void EX( Pipeline* pipe )
-{
-	int rsData, rtData, rdData;
-	int addr;
-
-	if (pipe->stageStat[EXStage].stalled == False)
-	{		
-		rsData = pipe->stageInst[EXStage].inst.rsData;
-		rtData = pipe->stageInst[EXStage].inst.rtData;	
-		rdData = pipe->stageInst[EXStage].inst.rdData;
-
-		if (pipe->stageInst[EXStage].inst.type != S)
-			pipe->exUtil++;
-		
-		if (pipe->stageInst[EXStage].inst.op == ADD)
-			pipe->stageInst[MEMStage].data = rsData + rtData;
-				
-		else if (pipe->stageInst[EXStage].inst.op == SUB)
-			pipe->stageInst[MEMStage].data = rsData - rtData;
-		
-		else if (pipe->stageInst[EXStage].inst.op == AND)
-			pipe->stageInst[MEMStage].data = rsData & rtData;
-
-		else if (pipe->stageInst[EXStage].inst.op == OR)
-			pipe->stageInst[MEMStage].data = rsData | rtData;
-
-		else if (pipe->stageInst[EXStage].inst.op == XOR)
-			pipe->stageInst[MEMStage].data = rsData ^ rtData;
-
-		else if (pipe->stageInst[EXStage].inst.op == MUL)
-			pipe->stageInst[MEMStage].data = rsData * rtData;
-							
-		else if (pipe->stageInst[EXStage].inst.op == SLL)
-		{
-			assert(rtData >= 0);
-			pipe->stageInst[MEMStage].data = rsData << rtData;
-		}
-		else if (pipe->stageInst[EXStage].inst.op == SRL)
-		{
-			assert(rtData >= 0);
-			pipe->stageInst[MEMStage].data = (int)((unsigned int)rsData >> rtData);
-		}
-		else if (pipe->stageInst[EXStage].inst.op == SRA)
-		{
-			assert(rtData >= 0);
-			pipe->stageInst[MEMStage].data = rsData >> rtData;
-		}
-		else if (pipe->stageInst[EXStage].inst.op == LW)						
-			pipe->stageInst[MEMStage].addr = rsData + rtData;
-
-		else if (pipe->stageInst[EXStage].inst.op == SW)
-		{
-			pipe->stageInst[MEMStage].addr = rsData + rtData;
-			pipe->stageInst[MEMStage].data = rdData;
-		}
-		else if (pipe->stageInst[EXStage].inst.op == LL)
-		{
-			pipe->stageInst[MEMStage].addr = rsData + rtData;
-			setCoreWatchFlag( pipe->bus, pipe->cache->id, pipe->stageInst[MEMStage].addr );
-		}
-		else if (pipe->stageInst[EXStage].inst.op == SC)
-		{
-			addr = rsData + rtData;
-			if ( getCoreWatchResult(pipe->bus, pipe->cache->id, addr) == True ) // Core watch flag is OK
-			{
-				pipe->stageInst[MEMStage].addr = rsData + rtData;
-				pipe->stageInst[MEMStage].data = rdData;
-				pipe->stageInst[MEMStage].inst.rdData = 1; // the data to be written in WB to rd register
-			}
-			else // Do not write memory in MEM
-			{
-				pipe->stageInst[MEMStage].addr = -1;
-				pipe->stageInst[MEMStage].data = -1;
-				pipe->stageInst[MEMStage].inst.rdData = 0; // the data to be written in WB to rd register
-			}
-		}
-		else
-			assert(!"Unrecognized Instruction");
-		
-				
-		// Pass the Instruction to the next Stage
-		pipe->stageInst[MEMStage].inst = pipe->stageInst[EXStage].inst;
-	}
-
-	if (pipe->stageStat[EXStage].stallNextCycle)
-	{
-		pipe->stageStat[EXStage].stalled = True;  // Stall next cycle
-		pipe->stageStat[EXStage].stallNextCycle = False;
-	}
-}
-
-void MEM( Pipeline* pipe )
-{
-	int memData;
-
-	if (pipe->stageStat[MEMStage].stalled == False)
-	{	
-		if (pipe->stageInst[MEMStage].inst.type != S)
-			pipe->memUtil++;
-
-		// Check if the Instruction is LW
-		bool isLoadFlag  = isLoad ( pipe->stageInst[MEMStage].inst.op );
-		// Check if the Instruction is SW or SC that writes the data cache/memory
-		bool isStoreFlag = isStore( pipe->stageInst[MEMStage].inst.op ) && !( pipe->stageInst[MEMStage].inst.op == SC && pipe->stageInst[MEMStage].data == -1 );
-				
-		if (isLoadFlag)
-		{
-			if (readFromCache(pipe->cache, pipe->stageInst[MEMStage].addr, &memData) == 1) // Hit on read in cache
-			{
-				pipe->stageInst[MEMStage].data = memData;
-				// Pass the Instruction to the next Stage
-				pipe->stageInst[WBStage].inst = pipe->stageInst[MEMStage].inst;
-			}
-			else // Miss on the data in cache
-			{
-				freezePipeline(pipe, MEMStage);
-				processorRead(pipe->bus, pipe->cache->id, pipe->stageInst[MEMStage].addr);
-			}
-		}
-		else if (isStoreFlag)
-		{
-			if (writeToCache(pipe->cache, pipe->stageInst[MEMStage].addr, pipe->stageInst[MEMStage].data) == 1)
-			{
-				// Pass the Instruction to the next Stage
-				pipe->stageInst[WBStage].inst = pipe->stageInst[MEMStage].inst;
-			}
-			// the block is invalid or shared
-			else
-			{
-				freezePipeline(pipe, MEMStage);
-				processorWrite(pipe->bus, pipe->cache->id, pipe->stageInst[MEMStage].addr, pipe->stageInst[MEMStage].data);
-			}			
-		}
-		else // Not load or store
-			// Pass the Instruction to the next Stage
-			pipe->stageInst[WBStage].inst = pipe->stageInst[MEMStage].inst;
-				
-	}
-
-	if (pipe->stageStat[MEMStage].stallNextCycle)
-	{
-		pipe->stageStat[MEMStage].stalled = True;  // Stall next cycle
-		pipe->stageStat[MEMStage].stallNextCycle = False;
-	}
-}
-
-void WB( Pipeline* pipe )
-{
-	// Do the delayed write from previous cycle if any pending
-	if (pipe->stageStat[WBStage].delayedWrite)
-	{
-		pipe->registers[ pipe->stageStat[WBStage].delayedWriteReg ] = pipe->stageStat[WBStage].delayedWriteData;
-		pipe->stageStat[WBStage].delayedWrite = False;
-	}
-
-	if (pipe->stageStat[WBStage].stalled == False)
-	{
-		if (pipe->stageInst[WBStage].inst.type != STR && pipe->stageInst[WBStage].inst.type != B && pipe->stageInst[WBStage].inst.type != H &&
-			pipe->stageInst[WBStage].inst.rd != 0 && pipe->stageInst[WBStage].inst.rd != 1)
-		{
-			// Check if JAL
-			if (pipe->stageInst[WBStage].inst.op == JAL)
-				pipe->stageInst[WBStage].inst.rd = 15;
-
-			// Check if SC
-			if (pipe->stageInst[WBStage].inst.op == SC)
-				pipe->stageInst[WBStage].data = pipe->stageInst[WBStage].inst.rdData;
-
-			// Store the write for next cycle
-			pipe->stageStat[WBStage].delayedWrite = True;
-			pipe->stageStat[WBStage].delayedWriteReg = pipe->stageInst[WBStage].inst.rd;
-			pipe->stageStat[WBStage].delayedWriteData = pipe->stageInst[WBStage].data;
-		}
-		if ( pipe->stageInst[WBStage].inst.op == HALT )
-			pipe->totally_done = True;
-		
-		if (pipe->stageInst[WBStage].inst.type != S)
-			pipe->wbUtil++;
-	}
-
-	if (pipe->stageStat[WBStage].stallNextCycle)
-	{
-		pipe->stageStat[WBStage].stalled = True;  // Stall next cycle
-		pipe->stageStat[WBStage].stallNextCycle = False;
-	}
-}
-
-// Put all stages except WB in stall mode and wait
-// The initiator of the stall is Stage st
-void freezePipeline( Pipeline* pipe, Stage st )
-{
-	int i;
-
-	for (i = IFStage; i < st; i++)
-		pipe->stageStat[i].stallNextCycle = True;		
-	
-	for (i = st; i < NumStages; i++)
-		pipe->stageStat[i].stalled = True;
-}
-
-// Unfreeze pipeline
-void unfreezePipeline(Pipeline* pipe)
-{
-	int i;
-
-	for (i = 0; i < NumStages; i++)
-	{
-		pipe->stageStat[i].stalled = False;
-		pipe->stageStat[i].stallNextCycle = False;
-	}
-}
-
-// All of the helper methods used by parser()
-void trimInstruction(char* Instruction) 
-{
-	int Stage = 0; // How many times we've gone from not a space to a space
-	int newIndex = 0;
-	char temp[100];
-	int i;
-	bool lastCharWasSpace = True;
-	for (i = 0; Instruction[i] != '\0'; i++) 
-	{
-		if (isAValidCharacter(Instruction[i]))  // Is alphanumeric or a dollar sign or a comma or a dash or a parentheses
-		{
-			temp[newIndex++] = Instruction[i];
-			lastCharWasSpace = False;
-		}
-		else 
-		{ //Basically is a space
-			if (Instruction[i] == ';')  // Comment
-				break;
-			if (!lastCharWasSpace) 
-			{
-				Stage++;
-				if (Stage == 1) {
-					temp[newIndex++] = ' ';
-				}
-			}
-			lastCharWasSpace = True;
-		}
-	}
-	temp[newIndex++] = '\0';
-	strcpy(Instruction, temp);
-}
-
-bool isAValidCharacter(char c) 
-{
-	return isalnum(c) || c == '$' || c == ',' || c == '-' || c == '(' || c == ')';
-}
-
-bool isAValidReg(char c) 
-{
-	return isalnum(c) || c == '$';
-}
-
-char* extractOpcode(char* Instruction) 
-{
-	char* opcode = (char*) malloc( sizeof(char) * (MAX_OPCODE+1) );
-	int i;
-
-	if (opcode == NULL)
-		return NULL;
-
-	for (i = 0; Instruction[i] != ' '; i++) {
-		opcode[i] = Instruction[i];
-	}
-	opcode[i] = '\0';
-	return opcode;
-}
-
-int extractRegister(char* Instruction, int index) 
-{
-	int i;
-	int regIndex = 0;
-	int charIndex = 0;
-	bool readOpcode = False;
-	char reg[MAX_REG_NAME + 1]; //Must be able to hold $rnn, which is 4 characters and the '\0' character
-
-	for (i = 0; Instruction[i] != '\0'; i++) 
-	{
-		if (readOpcode && Instruction[i] == ',') {
-			regIndex++;
-		}
-		if (readOpcode && isAValidReg(Instruction[i]) && index == regIndex) {
-			reg[charIndex++] = Instruction[i];
-		}
-		if (Instruction[i] == ' ') {
-			readOpcode = True;
-		}
-	}
-	reg[charIndex++] = '\0';
-	
-	//Checking if it's a valid register
-	if (reg[0] != '$') {
-		assert(!"Register didn't start with a dollar sign");
-	}
-	//Set regValue to  the string without the dollar sign
-	int regVal = regValue(reg + 1);
-	//Register is invalid
-	if (regVal == -1) 
-	{
-		assert(!"Unrecognized register name");
-	}
-	return regVal;
-}
-
-int extractImmediate(char* Instruction, int index) 
-{
-	int i;
-	int regIndex = 0;
-	int charIndex = 0;
-	bool readOpcode = False;
-	char immStr[6]; //To be able to hold $zero, which is 5 characters and the null character
-	int imm;
-
-	for (i = 0; Instruction[i] != '\0' && Instruction[i] != '('; i++) 
-	{
-		if (readOpcode && Instruction[i] == ',') {
-			regIndex++;
-		}
-		if (readOpcode && Instruction[i] != ',' && regIndex == index) {
-			immStr[charIndex++] = Instruction[i];
-		}
-		if (Instruction[i] == ' ') {
-			readOpcode = True;
-		}
-	}
-	immStr[charIndex++] = '\0';
-	//Make sure everything is a digit, or its the first character and its -
-	for (i = 0; immStr[i] != '\0'; i++) {
-		if (!isdigit(immStr[i])) 
-		{
-			if (!(i == 0 && immStr[i] == '-')) 
-				assert(!"Immediate field contained incorrect value");
-		}
-	}
-	imm = atoi(immStr);
-	if ( imm > (1 << 11)-1 || imm < -(1 << 11) )
-		assert(!"Immediate field too large");
-
-	return imm;
-}
-
-bool isRegularType(opcode opc) 
-{
-	if ( opc ==  ADD || opc == SUB || opc == AND || opc == OR || opc == XOR || opc == MUL || 
-		 opc == SLL || opc == SRL || opc == SRA || opc == LW || opc == LL )		
-		return True;
-
-	return False;
-}
-
-bool isJal(opcode opc)
-{
-	if ( opc == JAL )
-		return True;
-
-	return False;
-}
-
-bool isBranch(opcode opc)
-{
-	if ( opc == BEQ || opc == BNE || opc == BLT || opc == BGT || opc == BLE || opc == BGE )		 
-		return True;
-
-	return False;
-}
-
-bool isStore(opcode opc)
-{
-	if ( opc == SW || opc == SC )
-		return True;
-
-	return False;
-}
-
-bool isLoad(opcode opc)
-{
-	if (opc == LW || opc == LL)
-		return True;
-
-	return False;
-}
-
-bool isHalt(opcode opc)
-{
-	if ( opc == HALT )
-		return True;
-
-	return False;
-}
-
-//Returns the location (0-15) of the register from the name
-//Note: This takes in a register without the dollar sign, ex. s3, v0, 20, 5, zero
-int regValue(char* c) 
-{
-	/* Check if /* $r0-$r15 (or $R0-$R15) format or $0-$15 format */
-	if (c[0] == 'r' || c[0] == 'R') 
-		c++;
-	
-	
-	/* All the characters from now till end of c must be numbers
-	   If they are, then we convert it to a number and check if its between 0 and 15
-	   Otherwise: failure (return -1) */
-	int i = 0;
-	while ( c[i] != '\0' ) 
-	{
-		if ( !isdigit( c[i]) )
-			return -1;
-		i++;
-	}
-
-	/* If we've made it here, the string is a number */
-	int regIndex = atoi(c);
-	if ( regIndex >= 0 && regIndex <= NUM_REGS-1 ) 
-		return regIndex;	
-	else 
-		assert(!"Register number is out of bounds");
-
-	return -1;
-}
-
-
-int checkHazard( Pipeline* pipe )
-{
-	//If we have a hazard on register 0 or register 1, we don't actually have a hazard
-	Instruction inst = pipe->stageInst[IDStage].inst;
-	int result;
-
-	if (pipe->stageInst[IDStage].inst.type != S) 
-	{
-		// Check rs register
-		result = checkHazardRegister(pipe, inst.rs);
-		if (result != -1)
-			return result;		
-
-		// Check rt register
-		result = checkHazardRegister(pipe, inst.rt);
-		if (result != -1)
-			return result;
-
-		// Check rd register, only for store instructions ()
-		if (pipe->stageInst[IDStage].inst.type == STR)
-		{
-			result = checkHazardRegister(pipe, inst.rd);
-			if (result != -1)
-				return result;
-		}
-	}
-	return -1;
-}
-
-int checkHazardRegister(Pipeline* pipe, int reg)
-{
-	Instruction inst = pipe->stageInst[IDStage].inst;
-
-	// Check rt register
-	if (inst.type == Reg || inst.type == B || inst.type == STR)
-	{
-		if (!pipe->stageStat[EXStage].stalled && pipe->stageInst[EXStage].inst.type != S &&
-			reg == pipe->stageInst[EXStage].inst.rd && pipe->stageInst[EXStage].inst.type != STR)
-		{
-			if (inst.rs != 0 && inst.rs != 1)
-			{
-				pipe->dataHazardStallCycles = 3;
-				pipe->stalledDataHazard = True;
-				return reg;
-			}
-		}
-
-		if (!pipe->stageStat[MEMStage].stalled && pipe->stageInst[MEMStage].inst.type != S &&
-			reg == pipe->stageInst[MEMStage].inst.rd && pipe->stageInst[MEMStage].inst.type != STR)
-		{
-			if (inst.rs != 0 && inst.rs != 1)
-			{
-				pipe->dataHazardStallCycles = 2;
-				pipe->stalledDataHazard = True;
-				return reg;
-			}
-		}
-
-		if (!pipe->stageStat[WBStage].stalled && pipe->stageInst[WBStage].inst.type != S &&
-			reg == pipe->stageInst[WBStage].inst.rd && pipe->stageInst[WBStage].inst.type != STR)
-		{
-			{
-				pipe->dataHazardStallCycles = 1;
-				pipe->stalledDataHazard = True;
-				return reg;
-			}
-		}
-	}
-
-	return -1;
-}
-
-opcode stringToOpcode(char* opcode) {
-	if (strcmp(opcode, "add") == 0)
-		return ADD;
-	
-	else if (strcmp(opcode, "sub") == 0)
-		return SUB;
-	
-	else if (strcmp(opcode, "and") == 0)
-		return AND;
-	
-	else if (strcmp(opcode, "or") == 0)
-		return OR;
-	
-	else if (strcmp(opcode, "xor") == 0)
-		return XOR;
-
-	else if (strcmp(opcode, "mul") == 0)
-		return MUL;
-
-	else if (strcmp(opcode, "sll") == 0)
-		return SLL;
-	
-	else if (strcmp(opcode, "sra") == 0)
-		return SRA;
-	
-	else if (strcmp(opcode, "srl") == 0)
-		return SRL;
-
-	else if (strcmp(opcode, "beq") == 0)
-		return BEQ;
-	
-	else if (strcmp(opcode, "bne") == 0)
-		return BNE;
-	
-	else if (strcmp(opcode, "blt") == 0)
-		return BLT;
-	
-	else if (strcmp(opcode, "bgt") == 0)
-		return BGT;
-
-	else if (strcmp(opcode, "ble") == 0)
-		return BLE;
-
-	else if (strcmp(opcode, "bge") == 0)
-		return BGE;
-
-	else if (strcmp(opcode, "lw") == 0)
-		return LW;
-
-	else if (strcmp(opcode, "sw") == 0)
-		return SW;
-
-	else if (strcmp(opcode, "ll") == 0)
-		return LL;
-
-	else if (strcmp(opcode, "sc") == 0)
-		return SC;
-
-	else if (strcmp(opcode, "halt") == 0) 
-		return HALT;
-	/*
-		else if (strcmp(opcode, "nop") == 0)
-			return STALL;
-	*/	
-	return NONE;
-}
-
-void printStatistics( Pipeline* pipe )
-{
-	printf("IF Utilization: %.2f%%\n",  1.0 * pipe->ifUtil  / pipe->totalCycles * 100);
-	printf("ID Utilization: %.2f%%\n",  1.0 * pipe->idUtil  / pipe->totalCycles * 100);
-	printf("EX Utilization: %.2f%%\n",  1.0 * pipe->exUtil  / pipe->totalCycles * 100);
-	printf("MEM Utilization: %.2f%%\n", 1.0 * pipe->memUtil / pipe->totalCycles * 100);
-	printf("WB Utilization: %.2f%%\n",  1.0 * pipe->wbUtil  / pipe->totalCycles * 100);
-	printf("Execution Time (Cycles): %d\n", pipe->totalCycles);
-}
-
-void printRegisters( Pipeline* pipe )
-{
-	int i;
-
-	for (i = 0; i < NUM_REGS; i++) 
-		printf("Register $R%d: %d\n", i, pipe->registers[i]);	
-}
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "Pipeline2.h"
+#include "ProgramImage.h"
+#include "Assembler.h"
+#include "Profile.h"
+#include "PCProfile.h"
+
+static const Instruction bubble = { S, STALL, 0, 0, 0, False };
+
+static const char* cycleBucketNames[NumCycleBuckets] =
+{
+	"base", "dataHazard", "branchFlush", "busWait", "memoryWait", "transfer", "scRetry", "frontEnd", "halted"
+};
+
+Pipeline* createPipeline()
+{
+	Pipeline *pipe = (Pipeline *) malloc(sizeof(Pipeline));
+
+	if (pipe != NULL)
+	{
+		pipe->predictor = NULL;
+		pipe->storeBuffer = NULL;
+		pipe->sharing = NULL;
+		pipe->pcProfile = NULL;
+		pipe->stackDistance = NULL;
+		pipe->shadows = NULL;
+	}
+	return pipe;
+}
+
+void destroyPipeline(Pipeline* pipe)
+{
+	if (pipe == NULL)
+		return;
+
+	destroyBranchPredictor(pipe->predictor);
+	destroyStoreBuffer(pipe->storeBuffer);
+	free(pipe);
+}
+
+// Empty a latch slot, cause is charged for the cycle the bubble writes back
+void insertBubble(StageInstruction* slot, CycleBucket cause)
+{
+	slot->inst = bubble;
+	slot->bubbleCause = cause;
+}
+
+void initializePipeline( Pipeline *pipe, Program prog, struct MSIBus_ *bus, Cache cache )
+{
+	int i;
+
+	for (i = 0; i < NumStages; i++)
+	{				
+		pipe->stageStat[i].stalled = False;
+		pipe->stageStat[i].stallNextCycle = False;
+		pipe->stageStat[i].delayedWrite = False;
+		insertBubble(&pipe->stageInst[i], CycleFrontEnd);
+		pipe->stageInst[i].memDone = False;
+		insertBubble(&pipe->pairInst[i], CycleFrontEnd);
+		pipe->pairInst[i].memDone = False;
+	}
+	for (i = 0; i < NumCycleBuckets; i++)
+		pipe->cycleBuckets[i] = 0;
+	pipe->cycleBucket = CycleFrontEnd;
+	pipe->scRetry = False;
+	pipe->numStatsControls = 0;
+	pipe->stageStat[WBStage].pairDelayedWrite = False;
+
+	pipe->dataHazardStallCycles = 0;
+	pipe->stalledDataHazard = False;
+	pipe->forwarding = True;
+	pipe->issueWidth = 1;
+	pipe->fetchSlot = 0;
+	pipe->storeBufferWait = False;
+	pipe->flushBranchFlag = False;
+	pipe->branchTaken = False;
+	pipe->totally_done = False;      // True when halt has propagated through the pipeline
+	pipe->faulted = False;
+	pipe->interactive_mode = False;  // If True, print registers after each Instruction, wait for enter to be pressed
+
+
+	for (i = 0; i < NUM_REGS; i++)
+		pipe->registers[i] = 0;
+	pipe->PC = 0;
+	pipe->haltIndex = prog->haltIndex;
+	pipe->totalCycles = 0;
+	pipe->ifUtil = 0;
+	pipe->idUtil = 0;
+	pipe->exUtil = 0;
+	pipe->memUtil = 0;
+	pipe->wbUtil = 0;
+	pipe->dataStallCycles = 0;
+	pipe->loadUseStallCycles = 0;
+	pipe->stallCyclesAvoided = 0;
+	for (i = 0; i < NumForwardPaths; i++)
+		pipe->forwards[i] = 0;
+	pipe->branches = 0;
+	pipe->mispredictions = 0;
+	pipe->flushCycles = 0;
+	pipe->pairedIssues = 0;
+	pipe->bufferedStores = 0;
+	pipe->storeForwards = 0;
+	pipe->storeBufferStalls = 0;
+	pipe->storeCyclesHidden = 0;
+	pipe->fastForwarded = 0;
+
+	pipe->bus = bus;
+	pipe->cache = cache;
+	pipe->instruction_mem = prog->instructions;
+}
+
+void runPipelineOneCycle(Pipeline* pipe)
+{
+	char blank[2];
+	PROFILE_SCOPE(ProfilePipelineCycle);
+
+	WB(pipe);
+	if (pipe->totally_done) // Case of HALT processed
+		return;
+
+	MEM(pipe);
+	EX(pipe);
+	ID(pipe);
+	IF(pipe);
+	if (pipe->storeBuffer != NULL)
+		drainStoreBuffer(pipe);
+	pipe->totalCycles++;
+	pipe->cycleBuckets[pipe->scRetry ? CycleSCRetry : pipe->cycleBucket]++;
+	if (pipe->interactive_mode)
+	{
+		printRegisters(pipe);
+		printStatistics(pipe);
+		printf("Press ENTER to continue.\n");
+		fgets(blank, sizeof(blank), stdin);
+	}
+}
+
+void runPipelineFully( Pipeline* pipe )
+{	
+	// Then start iterating over the pipelined stages in reverse
+	while (!pipe->totally_done)
+		runPipelineOneCycle(pipe);
+
+	printStatistics(pipe);
+	printRegisters (pipe);
+}
+
+Program createProgram()
+{
+	Program prog = (Program)malloc(sizeof(struct Program_));
+
+	if (prog == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for program.\n");
+		return NULL;
+	}
+
+	prog->capacity = INITIAL_INSTRUCTIONS;
+	prog->instructions = (Instruction*)malloc(prog->capacity * sizeof(Instruction));
+	if (prog->instructions == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for program.\n");
+		free(prog);
+		return NULL;
+	}
+
+	prog->numInstructions = 0;
+	prog->haltIndex = 0;
+	prog->mapping = NULL;
+	prog->mappingSize = 0;
+	return prog;
+}
+
+void destroyProgram(Program prog)
+{
+	if (prog == NULL)
+		return;
+
+	if (prog->mapping != NULL)
+		unmapProgramImage(prog);
+	else
+		free(prog->instructions);
+	free(prog);
+}
+
+Program loadProgram(char* fileName)
+{
+	Program prog;
+
+	if (isProgramImage(fileName))
+		return mapProgramImage(fileName, True);
+
+	prog = createProgram();
+
+	if (prog != NULL && !progScanner(prog, fileName))
+	{
+		destroyProgram(prog);
+		return NULL;
+	}
+	return prog;
+}
+
+int progScanner(Program prog, char* filename)
+{
+	return assembleFile(prog, filename) == 0;
+}
+
+int progTextScanner(Program prog, const char* text)
+{
+	return assembleProgram(prog, text, strlen(text), "<text>") == 0;
+}
+
+// Slot of a stage latch: 0 is the older instruction, 1 the younger one of a dual-issue pair
+StageInstruction* getSlot(Pipeline* pipe, Stage st, int slot)
+{
+	return (slot == 0) ? &pipe->stageInst[st] : &pipe->pairInst[st];
+}
+
+// Fetch the instruction at PC into an ID latch slot. Returns False when the
+// rest of the fetch group must stay empty: fetch does not continue past a
+// JAL, which ID redirects, past a halt, or past a branch predicted taken.
+bool fetchInstruction(Pipeline* pipe, StageInstruction* slot)
+{
+	int target;
+
+	slot->inst = pipe->instruction_mem[pipe->PC];
+	slot->pc = pipe->PC;
+	slot->predictedTaken = False;
+
+	if (slot->inst.type != S)
+		pipe->ifUtil++;
+
+	// Follow the predicted target of a branch, ID recovers when it is wrong
+	if (pipe->predictor != NULL && isBranch(slot->inst.op) && predictBranch(pipe->predictor, pipe->PC, &target))
+	{
+		slot->predictedTaken = True;
+		pipe->PC = target;
+		return False;
+	}
+	if (slot->inst.isHalt)
+		return False;
+
+	pipe->PC++;
+	return slot->inst.op != JAL;
+}
+
+void IF( Pipeline* pipe )
+{		
+	bool fetching;
+	int slot;
+	PROFILE_SCOPE(ProfileIF);
+
+	if ( pipe->stageStat[IFStage].stalled == False && pipe->stalledDataHazard == False )
+	{		
+		if ( pipe->branchTaken ) // Flush when branch taken
+		{
+			if (pipe->flushBranchFlag)
+			{
+				insertBubble(&pipe->stageInst[IDStage], CycleBranchFlush);
+				insertBubble(&pipe->pairInst[IDStage], CycleBranchFlush);
+				pipe->branchTaken = False;
+				pipe->flushBranchFlag = False;
+				pipe->flushCycles++;
+			}
+		}
+		else
+		{
+			// Fill the ID latch slots ID has freed, not past a JAL ID kept for next cycle
+			fetching = pipe->fetchSlot == 0 || pipe->stageInst[IDStage].inst.op != JAL;
+			for (slot = pipe->fetchSlot; slot < pipe->issueWidth; slot++)
+			{
+				if (fetching)
+					fetching = fetchInstruction(pipe, getSlot(pipe, IDStage, slot));
+				else
+					insertBubble(getSlot(pipe, IDStage, slot), CycleFrontEnd);
+			}
+		}	
+	}
+
+	if (pipe->stageStat[IFStage].stallNextCycle)
+	{
+		pipe->stageStat[IFStage].stalled = True;  // Stall next cycle
+		pipe->stageStat[IFStage].stallNextCycle = False;
+	}
+	
+}
+
+// Outcome of a branch by comparing its operands, a dense switch the compiler turns into a jump table
+bool isBranchTaken(opcode op, int rsData, int rtData)
+{
+	switch (op)
+	{
+	case BEQ: return rsData == rtData;
+	case BNE: return rsData != rtData;
+	case BLT: return rsData < rtData;
+	case BGT: return rsData > rtData;
+	case BLE: return rsData <= rtData;
+	case BGE: return rsData >= rtData;
+	default:  return False;
+	}
+}
+
+int checkIssueHazard(Pipeline* pipe, const Instruction* inst)
+{
+	return pipe->forwarding ? checkForwardHazard(pipe, inst) : checkHazard(pipe, inst);
+}
+
+// Rules for issuing the younger instruction of the ID latch with the older one:
+// branches, JAL and halt end a pair, the younger may not read the older's result,
+// memory operations must find a free cache port and LL/SC and atomics use the cache alone.
+bool canPairInstructions(Pipeline* pipe, const Instruction* older, const Instruction* younger)
+{
+	int memOps;
+
+	if (younger->type == S || older->type == S || older->type == B || older->type == J || older->type == H)
+		return False;
+	// Statistics control issues alone, so its region starts or ends between instructions,
+	// and so do atomics, which hold their block for the whole read-modify-write
+	if (older->type == CTL || younger->type == CTL || isAtomic(older->op) || isAtomic(younger->op))
+		return False;
+
+	if (writesRegister(older, younger->rs) || writesRegister(older, younger->rt) ||
+		(younger->type == STR && writesRegister(older, younger->rd)))
+		return False;
+
+	memOps = (isLoad(older->op) || isStore(older->op)) + (isLoad(younger->op) || isStore(younger->op));
+	if (memOps > pipe->cache->ports ||
+		(memOps > 1 && (older->op == LL || hasMemoryResult(older->op) || younger->op == LL || hasMemoryResult(younger->op))))
+		return False;
+
+	return checkIssueHazard(pipe, younger) < 0;
+}
+
+void faultPipeline(Pipeline* pipe, const StageInstruction* slot, const char* reason)
+{
+	fprintf(stderr, "Core %d stopped at instruction %d: %s.\n", pipe->cache->id, slot->pc, reason);
+	pipe->faulted = True;
+	pipe->totally_done = True;
+}
+
+// Read the operands of an instruction leaving ID and resolve it if it is a branch or JAL
+void decodeInstruction(Pipeline* pipe, StageInstruction* slot)
+{
+	int rs, rt, rd;	
+	int legacyStall = 0;
+	Instruction* inst = &slot->inst;
+	bool taken;
+
+	if (inst->type != S)
+		pipe->idUtil++;
+
+	rs = inst->rs;
+	rt = inst->rt;
+	rd = inst->rd;
+
+	if ( rs > NUM_REGS - 1 || rt > NUM_REGS - 1 || rd > NUM_REGS - 1 ||
+		 rs < -1 || rt < -1 || rd < -1 )
+	{
+		faultPipeline(pipe, slot, "invalid register");
+		return;
+	}
+
+	if ( rd == 1 && inst->type != B && inst->type != J)
+	{
+		faultPipeline(pipe, slot, "destination register cannot be R1");
+		return;
+	}
+
+	// Read the registers, branches compare the values read here
+	if ( rs != -1 )
+		inst->rsData = readForwardedRegister(pipe, rs, &legacyStall);
+	if ( rt != -1 )
+		inst->rtData = readForwardedRegister(pipe, rt, &legacyStall);
+	if ( rt == -1 && inst->hasImm )
+		inst->rtData = inst->imm;
+	if ( inst->type == STR ) // Data to store
+		inst->rdData = readForwardedRegister(pipe, rd, &legacyStall);
+	else if ( inst->type == B || inst->type == J ) // Place immediate in rdData
+		inst->rdData = inst->imm;
+	else if ( rd != -1 )
+		inst->rdData = pipe->registers[rd];
+	pipe->stallCyclesAvoided += legacyStall;
+
+	if (inst->op == JAL)
+	{
+		slot->data = slot->pc + 1; // Return address
+		pipe->PC = inst->rdData;				
+	}
+
+	// Resolve branches, and recover from a misprediction: redirect IF and flush the instruction it fetches now
+	if (isBranch(inst->op))
+	{
+		taken = isBranchTaken(inst->op, inst->rsData, inst->rtData);
+		pipe->branches++;
+		if (taken != slot->predictedTaken)
+		{
+			pipe->mispredictions++;
+			pipe->PC = taken ? inst->rdData : slot->pc + 1;
+			pipe->branchTaken = True;
+			pipe->flushBranchFlag = True;
+		}
+		if (pipe->predictor != NULL)
+			updateBranchPredictor(pipe->predictor, slot->pc, taken, inst->rdData);
+	}
+}
+
+void ID( Pipeline* pipe )
+{	
+	StageInstruction* older = &pipe->stageInst[IDStage];
+	StageInstruction* younger = &pipe->pairInst[IDStage];
+	bool paired = False;
+	PROFILE_SCOPE(ProfileID);
+	pipe->branchTaken = False;
+
+	// The hazard is checked again every cycle until the producer has written back
+	if (pipe->stageStat[IDStage].stalled == False)
+		pipe->stalledDataHazard = False;
+
+	if (pipe->stageStat[IDStage].stalled == False && pipe->stalledDataHazard == False )
+	{		
+		//If there's no hazard
+		if ( checkIssueHazard(pipe, &older->inst) < 0 ) 
+		{
+			// Both instructions read their operands before the EX latch is overwritten
+			decodeInstruction(pipe, older);
+			if (pipe->issueWidth > 1 && !pipe->branchTaken && canPairInstructions(pipe, &older->inst, &younger->inst))
+			{
+				decodeInstruction(pipe, younger);
+				pipe->pairedIssues++;
+				paired = True;
+			}
+
+			// Pass the Instruction to the next Stage
+			pipe->stageInst[EXStage].inst = older->inst;
+			pipe->stageInst[EXStage].data = older->data;
+			pipe->stageInst[EXStage].pc = older->pc;
+			pipe->stageInst[EXStage].bubbleCause = older->bubbleCause;
+			pipe->pairInst[EXStage].inst = paired ? younger->inst : bubble;
+			pipe->pairInst[EXStage].data = younger->data;
+			pipe->pairInst[EXStage].pc = younger->pc;
+
+			// An unpaired younger instruction issues first next cycle, unless it was fetched
+			// after a mispredicted branch
+			pipe->fetchSlot = 0;
+			if (!paired && younger->inst.type != S && !pipe->branchTaken)
+			{
+				*older = *younger;
+				pipe->fetchSlot = 1;
+			}
+			insertBubble(younger, CycleFrontEnd);
+		}
+		else // Insert bubble to EX Stage and stall IF and ID
+		{						
+			insertBubble(&pipe->stageInst[EXStage], CycleDataHazard);
+			insertBubble(&pipe->pairInst[EXStage], CycleDataHazard);
+			pipe->stalledDataHazard = True;
+			pipe->dataStallCycles++;
+			if (pipe->forwarding && older->inst.type != B) // Only loads hold back other instructions
+				pipe->loadUseStallCycles++;
+		}
+	}
+
+	if (pipe->stageStat[IDStage].stallNextCycle)
+	{
+		pipe->stageStat[IDStage].stalled = True;  // Stall next cycle
+		pipe->stageStat[IDStage].stallNextCycle = False;
+	}
+}
+
+// EX handlers of each opcode, in is the instruction in EX and out the MEM latch
+void executeAdd(Pipeline* pipe, StageInstruction* in, StageInstruction* out) { out->data = in->inst.rsData + in->inst.rtData; }
+void executeSub(Pipeline* pipe, StageInstruction* in, StageInstruction* out) { out->data = in->inst.rsData - in->inst.rtData; }
+void executeAnd(Pipeline* pipe, StageInstruction* in, StageInstruction* out) { out->data = in->inst.rsData & in->inst.rtData; }
+void executeOr (Pipeline* pipe, StageInstruction* in, StageInstruction* out) { out->data = in->inst.rsData | in->inst.rtData; }
+void executeXor(Pipeline* pipe, StageInstruction* in, StageInstruction* out) { out->data = in->inst.rsData ^ in->inst.rtData; }
+void executeMul(Pipeline* pipe, StageInstruction* in, StageInstruction* out) { out->data = in->inst.rsData * in->inst.rtData; }
+
+// Shift amounts use the low 5 bits
+void executeSll(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->data = (int)((unsigned int)in->inst.rsData << (in->inst.rtData & 31));
+}
+
+void executeSrl(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->data = (int)((unsigned int)in->inst.rsData >> (in->inst.rtData & 31));
+}
+
+void executeSra(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->data = in->inst.rsData >> (in->inst.rtData & 31);
+}
+
+void executeLoad(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->addr = in->inst.rsData + in->inst.rtData;
+}
+
+void executeStore(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->addr = in->inst.rsData + in->inst.rtData;
+	out->data = in->inst.rdData;
+}
+
+// CAS compares with rt, so its address is rs alone
+void executeCompareAndSwap(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->addr = in->inst.rsData;
+	out->data = in->inst.rdData;
+}
+
+void executeLoadLinked(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->addr = in->inst.rsData + in->inst.rtData;
+	setCoreWatchFlag( pipe->bus, pipe->cache->id, out->addr );
+}
+
+void executeJal(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	out->data = in->data; // Return address
+}
+
+// Branches were resolved in ID, halt, fence and statistics control have nothing to compute
+void executeNothing(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+}
+
+typedef void (*ExecuteHandler)(Pipeline* pipe, StageInstruction* in, StageInstruction* out);
+
+// Indexed by opcode
+static const ExecuteHandler executeHandlers[NUM_OPCODES] =
+{
+	executeAdd, executeSub, executeAnd, executeOr, executeXor, executeMul,          // ADD - MUL
+	executeSll, executeSra, executeSrl,                                             // SLL - SRL
+	executeNothing, executeNothing, executeNothing,                                 // BEQ - BLT
+	executeNothing, executeNothing, executeNothing,                                 // BGT - BGE
+	executeJal, executeLoad, executeStore, executeLoadLinked, executeStore,         // JAL - SC
+	executeNothing, executeNothing,                                                 // HALT, FENCE
+	executeNothing, executeNothing, executeNothing, executeNothing,                 // ROI_BEGIN - STATS_DUMP
+	executeStore, executeCompareAndSwap, executeStore                               // FADD, CAS, SWAP
+};
+
+void executeInstruction(Pipeline* pipe, StageInstruction* in, StageInstruction* out)
+{
+	if (in->inst.type != S)
+	{
+		pipe->exUtil++;
+
+		if (in->inst.op < 0 || in->inst.op >= NUM_OPCODES)
+		{
+			faultPipeline(pipe, in, "unrecognized instruction");
+			return;
+		}
+		executeHandlers[in->inst.op](pipe, in, out);
+	}
+
+	// Pass the Instruction to the next Stage
+	out->inst = in->inst;
+	out->pc = in->pc;
+	out->bubbleCause = in->bubbleCause;
+	out->memDone = False;
+}
+
+void EX( Pipeline* pipe )
+{
+	PROFILE_SCOPE(ProfileEX);
+	if (pipe->stageStat[EXStage].stalled == False)
+	{		
+		executeInstruction(pipe, &pipe->stageInst[EXStage], &pipe->stageInst[MEMStage]);
+		if (pipe->issueWidth > 1)
+			executeInstruction(pipe, &pipe->pairInst[EXStage], &pipe->pairInst[MEMStage]);
+	}
+
+	if (pipe->stageStat[EXStage].stallNextCycle)
+	{
+		pipe->stageStat[EXStage].stalled = True;  // Stall next cycle
+		pipe->stageStat[EXStage].stallNextCycle = False;
+	}
+}
+
+// Wait in MEM for the store buffer, drainStoreBuffer unfreezes the pipeline
+void waitForStoreBuffer(Pipeline* pipe)
+{
+	pipe->storeBufferStalls++;
+	pipe->storeBufferWait = True;
+	freezePipeline(pipe, MEMStage);
+}
+
+// Profile entry of the instruction, NULL when the PC profile is off
+PCProfileEntry* getProfileEntry(Pipeline* pipe, StageInstruction* slot)
+{
+	if (pipe->pcProfile == NULL)
+		return NULL;
+	return getPCProfileEntry(pipe->pcProfile, pipe->cache->id, slot->pc);
+}
+
+// Report an access completed in MEM to the analyses
+void recordAccess(Pipeline* pipe, StageInstruction* slot, bool write)
+{
+	PCProfileEntry* entry = getProfileEntry(pipe, slot);
+
+	if (pipe->sharing != NULL)
+		recordSharingAccess(pipe->sharing, pipe->cache->id, slot->pc, slot->addr, write);
+	if (pipe->stackDistance != NULL)
+		recordReference(pipe->stackDistance, pipe->cache->id, slot->addr / BLOCK_SIZE);
+	if (pipe->shadows != NULL)
+		recordShadowAccess(pipe->shadows, pipe->cache->id, slot->addr / BLOCK_SIZE, write);
+	if (entry != NULL)
+		entry->accesses++;
+}
+
+// Report a miss sent to the bus, a block still tagged but invalid was taken by another core
+void recordMiss(Pipeline* pipe, StageInstruction* slot)
+{
+	PCProfileEntry* entry = getProfileEntry(pipe, slot);
+	Block block;
+
+	if (entry == NULL)
+		return;
+	entry->misses++;
+	if ((block = findBlock(pipe->cache, slot->addr)) != NULL && block->invalid && block->lastUsed > 0)
+		entry->coherenceMisses++;
+}
+
+// Value an atomic writes over the old one: the sum, rd if the old value equals rt, or rd
+int getAtomicResult(StageInstruction* slot, int old)
+{
+	switch (slot->inst.op)
+	{
+	case FADD: return old + slot->data;
+	case CAS:  return (old == slot->inst.rtData) ? slot->data : old;
+	default:   return slot->data;
+	}
+}
+
+// Access the cache for an instruction in MEM. Returns False and freezes the
+// pipeline on a miss; the access is retried once the bus has the block.
+// In a dual-issue pair the slot that already hit is not accessed again.
+// With a store buffer SW retires into it, loads read buffered stores first,
+// and SC, atomics, fence and halt wait until every older store is in the cache.
+bool accessMemory(Pipeline* pipe, StageInstruction* slot)
+{
+	int memData;
+	StoreBuffer sb = pipe->storeBuffer;
+	Block block;
+	PCProfileEntry* entry;
+
+	if (slot->memDone)
+		return True;
+
+	if (slot->inst.type != S)
+		pipe->memUtil++;
+
+	// Check if the Instruction is LW
+	bool isLoadFlag  = isLoad ( slot->inst.op );
+	// Check if the Instruction is SW or SC that writes the data cache/memory
+	bool isStoreFlag = isStore( slot->inst.op );
+
+	if (sb != NULL && slot->inst.type != S)
+	{
+		if (slot->inst.op == SW)
+		{
+			if (isStoreBufferFull(sb))
+			{
+				waitForStoreBuffer(pipe);
+				return False;
+			}
+			pushStore(sb, slot->addr, slot->data, pipe->totalCycles);
+			pipe->bufferedStores++;
+			recordAccess(pipe, slot, True);
+			slot->memDone = True;
+			return True;
+		}
+		if ((hasMemoryResult(slot->inst.op) || isFence(slot->inst.op) || isHalt(slot->inst.op)) && !isStoreBufferEmpty(sb))
+		{
+			waitForStoreBuffer(pipe);
+			return False;
+		}
+		if (isLoadFlag && forwardStore(sb, slot->addr, &memData))
+		{
+			slot->data = memData;
+			pipe->storeForwards++;
+			recordAccess(pipe, slot, False);
+			slot->memDone = True;
+			return True;
+		}
+	}
+			
+	if (isLoadFlag)
+	{
+		// A miss waits while the store buffer holds the core's bus request,
+		// the completion of that request unfreezes the pipeline
+		if (sb != NULL && pipe->bus->pendingCmd[pipe->cache->id] != NoCommand &&
+			((block = findBlock(pipe->cache, slot->addr)) == NULL || block->invalid))
+		{
+			freezePipeline(pipe, MEMStage);
+			return False;
+		}
+		if (readFromCache(pipe->cache, slot->addr, &memData) != 1) // Miss on the data in cache
+		{
+			recordMiss(pipe, slot);
+			freezePipeline(pipe, MEMStage);
+			processorRead(pipe->bus, pipe->cache->id, slot->addr);
+			return False;
+		}
+		slot->data = memData;
+	}
+	else if (slot->inst.op == SC && !isCoreWatching(pipe->bus, pipe->cache->id, slot->addr))
+	{
+		slot->inst.rdData = 0; // Link broken, rd gets 0 in WB and memory is not written
+		pipe->scRetry = True;
+	}
+	else if (isAtomic(slot->inst.op))
+	{
+		// The old value is read and the new one written in the cycle the block
+		// is found modified, so no other core can access it in between
+		block = findBlock(pipe->cache, slot->addr);
+		memData = (block != NULL) ? block->data : 0;
+		if (writeToCache(pipe->cache, slot->addr, getAtomicResult(slot, memData)) != 1) // the block is invalid or shared
+		{
+			recordMiss(pipe, slot);
+			freezePipeline(pipe, MEMStage);
+			processorWrite(pipe->bus, pipe->cache->id, slot->addr, slot->data);
+			return False;
+		}
+		slot->inst.rdData = memData;
+		breakCoreWatches(pipe->bus, pipe->cache->id, slot->addr);
+	}
+	else if (isStoreFlag)
+	{
+		// SC decides when the block is owned and the write is done in the same
+		// cycle, so no LL of another core can read the old value after it succeeds
+		if (writeToCache(pipe->cache, slot->addr, slot->data) != 1) // the block is invalid or shared
+		{
+			recordMiss(pipe, slot);
+			freezePipeline(pipe, MEMStage);
+			processorWrite(pipe->bus, pipe->cache->id, slot->addr, slot->data);
+			return False;
+		}
+		if (slot->inst.op == SC)
+		{
+			slot->inst.rdData = getCoreWatchResult(pipe->bus, pipe->cache->id, slot->addr) ? 1 : 0;
+			pipe->scRetry = (slot->inst.rdData == 0);
+		}
+	}
+
+	if (isLoadFlag || isAtomic(slot->inst.op) || (isStoreFlag && !(slot->inst.op == SC && slot->inst.rdData == 0)))
+		recordAccess(pipe, slot, !isLoadFlag);
+	else if (slot->inst.op == SC && (entry = getProfileEntry(pipe, slot)) != NULL)
+	{
+		entry->accesses++;
+		entry->scFailures++;
+	}
+	slot->memDone = True;
+	return True;
+}
+
+void drainStoreBuffer(Pipeline* pipe)
+{
+	StoreBufferEntry* oldest = getOldestStore(pipe->storeBuffer);
+	PROFILE_SCOPE(ProfileStoreBuffer);
+
+	// Only one bus request per core, a load miss or the oldest store's own request may hold it
+	if (oldest != NULL && pipe->bus->pendingCmd[pipe->cache->id] == NoCommand)
+	{
+		if (writeToCache(pipe->cache, oldest->addr, oldest->data) == 1)
+		{
+			pipe->storeCyclesHidden += pipe->totalCycles - oldest->cycle;
+			popStore(pipe->storeBuffer);
+		}
+		else // Ask for ownership, the store is written once the block is modified here
+			processorWrite(pipe->bus, pipe->cache->id, oldest->addr, oldest->data);
+	}
+
+	if (pipe->storeBufferWait)
+	{
+		pipe->storeBufferWait = False;
+		unfreezePipeline(pipe);
+	}
+}
+
+void MEM( Pipeline* pipe )
+{
+	PCProfileEntry* entry;
+	PROFILE_SCOPE(ProfileMEM);
+	if (pipe->stageStat[MEMStage].stalled == False)
+	{	
+		if (accessMemory(pipe, &pipe->stageInst[MEMStage]) &&
+			(pipe->issueWidth == 1 || accessMemory(pipe, &pipe->pairInst[MEMStage])))
+		{
+			// Pass the Instruction to the next Stage
+			pipe->stageInst[WBStage] = pipe->stageInst[MEMStage];
+			pipe->pairInst[WBStage] = pipe->pairInst[MEMStage];
+		}
+	}
+	else if (pipe->pcProfile != NULL) // Frozen on the older slot unless it already accessed the cache
+	{
+		entry = getProfileEntry(pipe, pipe->stageInst[MEMStage].memDone ? &pipe->pairInst[MEMStage] : &pipe->stageInst[MEMStage]);
+		if (entry != NULL)
+			entry->frozenCycles++;
+	}
+
+	if (pipe->stageStat[MEMStage].stallNextCycle)
+	{
+		pipe->stageStat[MEMStage].stalled = True;  // Stall next cycle
+		pipe->stageStat[MEMStage].stallNextCycle = False;
+	}
+}
+
+// Write back one instruction, the register write is held until next cycle
+void writeBackInstruction(Pipeline* pipe, StageInstruction* slot, bool* delayedWrite, int* delayedWriteReg, int* delayedWriteData)
+{
+	if ((slot->inst.type != STR || hasMemoryResult(slot->inst.op)) &&
+		slot->inst.type != B && slot->inst.type != H && slot->inst.type != S &&
+		slot->inst.rd > 1)
+	{
+		// Check if JAL
+		if (slot->inst.op == JAL)
+			slot->inst.rd = 15;
+
+		// SC and atomics write the result of MEM
+		if (hasMemoryResult(slot->inst.op))
+			slot->data = slot->inst.rdData;
+
+		// Store the write for next cycle
+		*delayedWrite = True;
+		*delayedWriteReg = slot->inst.rd;
+		*delayedWriteData = slot->data;
+	}
+	if ( slot->inst.op == HALT )
+		pipe->totally_done = True;
+	if (slot->inst.type == CTL)
+		pipe->statsControls[pipe->numStatsControls++] = slot->inst.op;
+	
+	if (slot->inst.type != S)
+		pipe->wbUtil++;
+}
+
+// Bucket of the cycle by what is in WB. A bubble left by a frozen MEM is
+// charged to the state of the core's bus request.
+CycleBucket getCycleBucket(Pipeline* pipe)
+{
+	MSIBus bus = pipe->bus;
+	CycleBucket cause = pipe->stageInst[WBStage].bubbleCause;
+
+	if (pipe->stageInst[WBStage].inst.type != S || pipe->pairInst[WBStage].inst.type != S)
+		return CycleBase;
+	if (cause == CycleBusWait && !pipe->storeBufferWait && bus->busBusy && bus->busOrigid == pipe->cache->id)
+		return (bus->busSupplier == MEMId) ? CycleMemoryWait : CycleTransfer;
+	return cause;
+}
+
+// Do the delayed writes if any pending, the younger one last
+void applyDelayedWrites(Pipeline* pipe)
+{
+	StageStatus* stat = &pipe->stageStat[WBStage];
+
+	if (stat->delayedWrite)
+	{
+		pipe->registers[ stat->delayedWriteReg ] = stat->delayedWriteData;
+		stat->delayedWrite = False;
+	}
+	if (stat->pairDelayedWrite)
+	{
+		pipe->registers[ stat->pairDelayedWriteReg ] = stat->pairDelayedWriteData;
+		stat->pairDelayedWrite = False;
+	}
+}
+
+void WB( Pipeline* pipe )
+{
+	StageStatus* stat = &pipe->stageStat[WBStage];
+	PROFILE_SCOPE(ProfileWB);
+
+	// Do the delayed writes from previous cycle
+	applyDelayedWrites(pipe);
+
+	if (stat->stalled == False)
+	{
+		writeBackInstruction(pipe, &pipe->stageInst[WBStage], &stat->delayedWrite, &stat->delayedWriteReg, &stat->delayedWriteData);
+		if (pipe->issueWidth > 1)
+			writeBackInstruction(pipe, &pipe->pairInst[WBStage], &stat->pairDelayedWrite, &stat->pairDelayedWriteReg,
+								 &stat->pairDelayedWriteData);
+
+		// A halt paired with an older instruction retires with it, the core runs no more cycles
+		if (pipe->totally_done)
+			applyDelayedWrites(pipe);
+	}
+	pipe->cycleBucket = getCycleBucket(pipe);
+
+	if (stat->stallNextCycle)
+	{
+		stat->stalled = True;  // Stall next cycle
+		stat->stallNextCycle = False;
+	}
+}
+
+// Put all stages except WB in stall mode and wait
+// The initiator of the stall is Stage st
+// Stages run from WB back to IF, so the stages before st have not run yet
+// in this cycle and must stall right away. WB drains a bubble meanwhile.
+void freezePipeline( Pipeline* pipe, Stage st )
+{
+	int i;
+
+	for (i = IFStage; i <= st; i++)
+		pipe->stageStat[i].stalled = True;
+
+	for (i = st + 1; i < NumStages; i++)
+	{
+		insertBubble(&pipe->stageInst[i], CycleBusWait);
+		insertBubble(&pipe->pairInst[i], CycleBusWait);
+	}
+}
+
+// Unfreeze pipeline
+void unfreezePipeline(Pipeline* pipe)
+{
+	int i;
+
+	for (i = 0; i < NumStages; i++)
+	{
+		pipe->stageStat[i].stalled = False;
+		pipe->stageStat[i].stallNextCycle = False;
+	}
+}
+
+// True when the instruction writes reg in WB, registers 0 and 1 are never written
+bool writesRegister(const Instruction* inst, int reg)
+{
+	return reg > 1 && inst->type != S && reg == inst->rd && (inst->type != STR || hasMemoryResult(inst->op));
+}
+
+bool isRegularType(opcode opc) 
+{
+	if ( opc ==  ADD || opc == SUB || opc == AND || opc == OR || opc == XOR || opc == MUL || 
+		 opc == SLL || opc == SRL || opc == SRA || opc == LW || opc == LL )		
+		return True;
+
+	return False;
+}
+
+bool isJal(opcode opc)
+{
+	if ( opc == JAL )
+		return True;
+
+	return False;
+}
+
+bool isBranch(opcode opc)
+{
+	if ( opc == BEQ || opc == BNE || opc == BLT || opc == BGT || opc == BLE || opc == BGE )		 
+		return True;
+
+	return False;
+}
+
+bool isStore(opcode opc)
+{
+	if ( opc == SW || opc == SC )
+		return True;
+
+	return False;
+}
+
+bool isLoad(opcode opc)
+{
+	if (opc == LW || opc == LL)
+		return True;
+
+	return False;
+}
+
+bool isHalt(opcode opc)
+{
+	if ( opc == HALT )
+		return True;
+
+	return False;
+}
+
+bool isFence(opcode opc)
+{
+	if ( opc == FENCE )
+		return True;
+
+	return False;
+}
+
+bool isStatsControl(opcode opc)
+{
+	return opc == ROI_BEGIN || opc == ROI_END || opc == STATS_RESET || opc == STATS_DUMP;
+}
+
+bool isAtomic(opcode opc)
+{
+	return opc == FADD || opc == CAS || opc == SWAP;
+}
+
+// SC and the atomics are stores that write rd with a result of MEM
+bool hasMemoryResult(opcode opc)
+{
+	return opc == SC || isAtomic(opc);
+}
+
+int checkHazard( Pipeline* pipe, const Instruction* inst )
+{
+	//If we have a hazard on register 0 or register 1, we don't actually have a hazard
+	int result;
+	PROFILE_SCOPE(ProfileCheckHazard);
+
+	if (inst->type != S) 
+	{
+		// Check rs register
+		result = checkHazardRegister(pipe, inst, inst->rs);
+		if (result != -1)
+			return result;		
+
+		// Check rt register
+		result = checkHazardRegister(pipe, inst, inst->rt);
+		if (result != -1)
+			return result;
+
+		// Check rd register, only for store instructions ()
+		if (inst->type == STR)
+		{
+			result = checkHazardRegister(pipe, inst, inst->rd);
+			if (result != -1)
+				return result;
+		}
+	}
+	return -1;
+}
+
+int checkForwardHazard( Pipeline* pipe, const Instruction* inst )
+{
+	int result = -1;
+
+	if (inst->type == Reg || inst->type == B || inst->type == STR)
+	{
+		result = checkForwardHazardRegister(pipe, inst, inst->rs);
+		if (result == -1)
+			result = checkForwardHazardRegister(pipe, inst, inst->rt);
+		if (result == -1 && inst->type == STR)
+			result = checkForwardHazardRegister(pipe, inst, inst->rd);
+	}
+	return result;
+}
+
+// Stages run from WB back to IF, so when ID runs the EX latch holds the
+// instructions EX has just executed and the WB latch the ones MEM has just
+// completed. Results of the former reach EX next cycle over EX->EX, of the
+// latter over MEM->EX, and the writes WB holds for next cycle reach ID.
+// Returns the path of the youngest instruction writing reg and its value,
+// -1 when the register file is current.
+int findProducer(Pipeline* pipe, int reg, const Instruction** producer, int* value)
+{
+	StageInstruction* slot;
+	StageStatus* stat = &pipe->stageStat[WBStage];
+	int i;
+
+	if (reg <= 1)
+		return -1;
+
+	for (i = pipe->issueWidth - 1; i >= 0; i--)
+	{
+		slot = getSlot(pipe, EXStage, i);
+		if (!pipe->stageStat[EXStage].stalled && writesRegister(&slot->inst, reg))
+		{
+			*producer = &slot->inst;
+			*value = getSlot(pipe, MEMStage, i)->data;
+			return ForwardEXEX;
+		}
+	}
+
+	for (i = pipe->issueWidth - 1; i >= 0; i--)
+	{
+		slot = getSlot(pipe, WBStage, i);
+		if (!stat->stalled && writesRegister(&slot->inst, reg))
+		{
+			*producer = &slot->inst;
+			*value = hasMemoryResult(slot->inst.op) ? slot->inst.rdData : slot->data;
+			return ForwardMEMEX;
+		}
+	}
+
+	*producer = NULL;
+	if (stat->pairDelayedWrite && reg == stat->pairDelayedWriteReg)
+	{
+		*value = stat->pairDelayedWriteData;
+		return ForwardWBID;
+	}
+	if (stat->delayedWrite && reg == stat->delayedWriteReg)
+	{
+		*value = stat->delayedWriteData;
+		return ForwardWBID;
+	}
+
+	return -1;
+}
+
+int checkForwardHazardRegister(Pipeline* pipe, const Instruction* inst, int reg)
+{
+	const Instruction* producer;
+	int value;
+
+	switch (findProducer(pipe, reg, &producer, &value))
+	{
+	case ForwardEXEX: // A load, SC or atomic has no result before MEM, a branch compares in ID
+		return (isLoad(producer->op) || hasMemoryResult(producer->op) || inst->type == B) ? reg : -1;
+	case ForwardMEMEX:
+		return (inst->type == B) ? reg : -1;
+	default:
+		return -1;
+	}
+}
+
+int readForwardedRegister(Pipeline* pipe, int reg, int* legacyStall)
+{
+	// Cycles stall-only would still wait for a result on each path
+	static const int stallCycles[NumForwardPaths] = { 3, 2, 1 };
+	const Instruction* producer;
+	int value, path;
+
+	if (!pipe->forwarding)
+		return pipe->registers[reg];
+
+	path = findProducer(pipe, reg, &producer, &value);
+	if (path < 0)
+		return pipe->registers[reg];
+
+	pipe->forwards[path]++;
+	if (stallCycles[path] > *legacyStall)
+		*legacyStall = stallCycles[path];
+	return value;
+}
+
+// Without forwarding an instruction waits in ID until every producer of its
+// operands has written the register file
+int checkHazardRegister(Pipeline* pipe, const Instruction* inst, int reg)
+{
+	const Instruction* producer;
+	int value;
+
+	// Registers 0 and 1 are never written, immediates have no register
+	if (reg <= 1)
+		return -1;
+
+	if (inst->type == Reg || inst->type == B || inst->type == STR)
+	{
+		switch (findProducer(pipe, reg, &producer, &value))
+		{
+		case ForwardEXEX:
+			pipe->dataHazardStallCycles = 3;
+			return reg;
+		case ForwardMEMEX:
+			pipe->dataHazardStallCycles = 2;
+			return reg;
+		case ForwardWBID: // WB writes the register file at the start of the next cycle
+			pipe->dataHazardStallCycles = 1;
+			return reg;
+		}
+	}
+
+	return -1;
+}
+
+// Utilizations are of the issue slots, pipe->issueWidth per stage and cycle
+void printStatistics( Pipeline* pipe )
+{
+	double slots = 1.0 * pipe->totalCycles * pipe->issueWidth;
+
+	printf("IF Utilization: %.2f%%\n",  pipe->ifUtil  / slots * 100);
+	printf("ID Utilization: %.2f%%\n",  pipe->idUtil  / slots * 100);
+	printf("EX Utilization: %.2f%%\n",  pipe->exUtil  / slots * 100);
+	printf("MEM Utilization: %.2f%%\n", pipe->memUtil / slots * 100);
+	printf("WB Utilization: %.2f%%\n",  pipe->wbUtil  / slots * 100);
+	printf("IPC: %.3f\n", 1.0 * pipe->wbUtil / pipe->totalCycles);
+	if (pipe->issueWidth > 1)
+		printf("Dual-Issue Cycles: %d\n", pipe->pairedIssues);
+	printf("Data Hazard Stall Cycles: %d\n", pipe->dataStallCycles);
+	if (pipe->forwarding)
+	{
+		printf("Load-Use Stall Cycles: %d\n", pipe->loadUseStallCycles);
+		printf("Stall Cycles Avoided by Forwarding: %d\n", pipe->stallCyclesAvoided);
+		printf("Forwards EX->EX / MEM->EX / WB->ID: %d / %d / %d\n", pipe->forwards[ForwardEXEX],
+			   pipe->forwards[ForwardMEMEX], pipe->forwards[ForwardWBID]);
+	}
+	if (pipe->branches > 0)
+		printf("Branch Prediction (%s): %.2f%% of %d, %d flush cycles\n",
+			   getPredictorSchemeName(pipe->predictor != NULL ? pipe->predictor->scheme : PredictNotTaken),
+			   100.0 * (pipe->branches - pipe->mispredictions) / pipe->branches, pipe->branches, pipe->flushCycles);
+	if (pipe->storeBuffer != NULL)
+	{
+		printf("Buffered Stores: %d, %d loads forwarded\n", pipe->bufferedStores, pipe->storeForwards);
+		printf("Store Buffer Stall Cycles: %d\n", pipe->storeBufferStalls);
+		printf("Store Latency Hidden (Cycles): %d\n", pipe->storeCyclesHidden);
+	}
+	printf("Execution Time (Cycles): %d\n", pipe->totalCycles);
+}
+
+void registerPipelineStats(Pipeline* pipe, StatsRegistry reg, const char* prefix)
+{
+	char cpiPrefix[MAX_STAT_NAME];
+	int i;
+
+	registerCounter(reg, prefix, "cycles", &pipe->totalCycles);
+	registerCounter(reg, prefix, "instructions", &pipe->wbUtil);
+	registerCounter(reg, prefix, "ifUtil", &pipe->ifUtil);
+	registerCounter(reg, prefix, "idUtil", &pipe->idUtil);
+	registerCounter(reg, prefix, "exUtil", &pipe->exUtil);
+	registerCounter(reg, prefix, "memUtil", &pipe->memUtil);
+	registerCounter(reg, prefix, "dataStallCycles", &pipe->dataStallCycles);
+	registerCounter(reg, prefix, "loadUseStallCycles", &pipe->loadUseStallCycles);
+	registerCounter(reg, prefix, "stallCyclesAvoided", &pipe->stallCyclesAvoided);
+	registerCounter(reg, prefix, "branches", &pipe->branches);
+	registerCounter(reg, prefix, "mispredictions", &pipe->mispredictions);
+	registerCounter(reg, prefix, "flushCycles", &pipe->flushCycles);
+	registerCounter(reg, prefix, "pairedIssues", &pipe->pairedIssues);
+	registerCounter(reg, prefix, "bufferedStores", &pipe->bufferedStores);
+	registerCounter(reg, prefix, "storeForwards", &pipe->storeForwards);
+	registerCounter(reg, prefix, "storeBufferStalls", &pipe->storeBufferStalls);
+	registerCounter(reg, prefix, "storeCyclesHidden", &pipe->storeCyclesHidden);
+	snprintf(cpiPrefix, MAX_STAT_NAME, "%s.cpi", prefix);
+	for (i = 0; i < NumCycleBuckets; i++)
+		registerCounter(reg, cpiPrefix, cycleBucketNames[i], &pipe->cycleBuckets[i]);
+}
+
+const char* getCycleBucketName(CycleBucket bucket)
+{
+	return cycleBucketNames[bucket];
+}
+
+void printCPIStack(FILE* out, const char* name, const int buckets[], int cycles, int instructions)
+{
+	int i;
+
+	fprintf(out, "CPI stack of %s: %d cycles, %d instructions, CPI %.3f\n", name, cycles, instructions,
+		instructions > 0 ? 1.0 * cycles / instructions : 0.0);
+	for (i = 0; i < NumCycleBuckets; i++)
+		fprintf(out, "  %-12s %10d %8.3f %6.1f%%\n", cycleBucketNames[i], buckets[i],
+			instructions > 0 ? 1.0 * buckets[i] / instructions : 0.0, cycles > 0 ? 100.0 * buckets[i] / cycles : 0.0);
+}
+
+void printRegisters( Pipeline* pipe )
+{
+	int i;
+
+	for (i = 0; i < NUM_REGS; i++) 
+		printf("Register $R%d: %d\n", i, pipe->registers[i]);	
+}
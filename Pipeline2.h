@@ -1,125 +1,234 @@
-#ifndef PIPELINE_H_
-#define PIPELINE_H_
-
-#include "Shared.h"
-#include "Cache.h"
-#include "MSIBus.h"
-
-#define MAX_OPCODE 4
-#define NUM_REGS 16
-#define MAX_REG_NAME 4
-#define MAX_INSTR_LEN 100
-#define MAX_INSTRUCTIONS 1024
-
-typedef enum { Reg, J, B, STR, H, S } instruction_type;  /* Regular is Reg, JAL is J, branch instructions are B,
-														  SW and SC are STR, halt is H  and stall is S */
-typedef enum 
-{
-	NONE = -2, STALL = -1, ADD = 0, SUB = 1, AND = 2, OR = 3, XOR = 4, MUL = 5, SLL = 6, SRA = 7, SRL = 8, BEQ = 9, BNE = 10,
-	BLT = 11, BGT = 12, BLE = 13, BGE = 14, JAL = 15, LW = 16, SW = 17, LL = 18, SC = 19, HALT = 20, NOP = 30
-} opcode;
-
-typedef enum { IFStage = 0, IDStage, EXStage, MEMStage, WBStage, NumStages } Stage;
-
-typedef struct 
-{
-	instruction_type type;
-	opcode op;
-	int rs, rt, rd;
-	bool hasImm;
-	int imm;
-	int rsData, rtData, rdData;
-	bool isHalt;
-} Instruction;
-
-typedef struct
-{
-	bool valid;
-	int data;
-	int addr;
-	Instruction inst;
-} StageInstruction;
-
-typedef struct
-{
-	bool stalled;
-	bool stallNextCycle;
-	bool delayedWrite;
-	int delayedWriteReg;
-	int delayedWriteData;
-} StageStatus;
-
-struct MSIBus;
-struct Pipeline
-{
-	struct MSIBus_* bus;
-	Cache cache;
-	int registers[NUM_REGS];
-	Instruction instruction_mem[MAX_INSTRUCTIONS];
-
-	/* Instructions in each of the stages */
-	StageInstruction stageInst[NumStages];
-
-	/* Stage status */
-	StageStatus stageStat[NumStages];
-
-	int dataHazardStallCycles;
-	bool stalledDataHazard;
-	bool flushBranchFlag;
-	bool branchTaken;
-	bool totally_done;      // True when halt has propagated through the pipeline
-	bool interactive_mode;  // If True, print registers after each Instruction, wait for enter to be pressed
-
-	int PC;
-	int haltIndex;
-	int totalCycles;
-	int ifUtil;
-	int idUtil;
-	int exUtil;
-	int memUtil;
-	int wbUtil;
-};
-typedef struct Pipeline Pipeline;
-typedef struct Pipeline* PipelinePtr;
-
-Pipeline* createPipeline();
-void destroyPipeline(Pipeline* pipe);
-void initializePipeline(Pipeline* pipe, char* fileName, struct MSIBus_* bus, Cache cache);
-void progScanner( Pipeline* pipe, char* filename );
-void parser( Pipeline* pipe, char* inst );
-void trimInstruction(char* inst);
-bool isAValidCharacter(char ch);
-bool isAValidReg(char ch);
-char* extractOpcode(char* inst);
-int extractRegister(char* inst, int num);
-int extractImmediate(char* inst, int num);
-opcode stringToOpcode(char* opcode);
-bool isRegularType(opcode opc);
-bool isJal(opcode opc);
-bool isBranch(opcode opc);
-bool isStore(opcode opc);
-bool isLoad(opcode opc);
-bool isHalt(opcode opc);
-int regValue(char* inst);
-int checkHazard( Pipeline* pipe );
-int checkHazardRegister(Pipeline* pipe, int reg);
-
-void runPipelineOneCycle(Pipeline* pipe);
-void runPipelineFully(Pipeline* pipe);
-// Put all stages in stall mode and wait
-// The initiator of the stall is Stage st
-void freezePipeline(Pipeline *pipe, Stage st);
-// Unfreeze pipeline
-void unfreezePipeline( Pipeline* pipe );
-
-void printStatistics( Pipeline* pipe );
-void printRegisters ( Pipeline* pipe );
-
-//Stage declarations
-void IF ( Pipeline* pipe );
-void ID ( Pipeline* pipe );
-void EX ( Pipeline* pipe );
-void MEM( Pipeline* pipe );
-void WB ( Pipeline* pipe );
-
-#endif
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+
+#include "Shared.h"
+#include "Cache.h"
+#include "MSIBus.h"
+#include "BranchPredictor.h"
+#include "StoreBuffer.h"
+#include "Stats.h"
+#include "Sharing.h"
+#include "StackDistance.h"
+#include "ShadowCache.h"
+
+#define NUM_REGS 16
+#define INITIAL_INSTRUCTIONS 1024   /* Instruction memory grows past this as needed */
+
+typedef enum { Reg, J, B, STR, H, S, FNC, CTL } instruction_type;  /* Regular is Reg, JAL is J, branch instructions are B,
+															   SW, SC and atomics are STR, halt is H, stall is S, fence
+															   is FNC and statistics control is CTL */
+typedef enum 
+{
+	NONE = -2, STALL = -1, ADD = 0, SUB = 1, AND = 2, OR = 3, XOR = 4, MUL = 5, SLL = 6, SRA = 7, SRL = 8, BEQ = 9, BNE = 10,
+	BLT = 11, BGT = 12, BLE = 13, BGE = 14, JAL = 15, LW = 16, SW = 17, LL = 18, SC = 19, HALT = 20, FENCE = 21,
+	ROI_BEGIN = 22, ROI_END = 23, STATS_RESET = 24, STATS_DUMP = 25, FADD = 26, CAS = 27, SWAP = 28, NOP = 30
+} opcode;
+#define NUM_OPCODES (SWAP + 1)  /* Opcodes of real instructions are 0 .. SWAP */
+
+typedef enum { IFStage = 0, IDStage, EXStage, MEMStage, WBStage, NumStages } Stage;
+
+/* CPI stack: every cycle of a core goes to one bucket. A cycle an instruction
+   writes back is base, otherwise the bubble in WB names its cause. */
+typedef enum
+{
+	CycleBase = 0,          /* An instruction wrote back */
+	CycleDataHazard,        /* Bubble of an instruction held in ID */
+	CycleBranchFlush,       /* Bubble fetched after a mispredicted branch */
+	CycleBusWait,           /* MEM frozen, the request waits for the bus or the store buffer */
+	CycleMemoryWait,        /* MEM frozen, memory is answering the request */
+	CycleTransfer,          /* MEM frozen, another cache is flushing the block */
+	CycleSCRetry,           /* From a failed SC until the core's next successful one */
+	CycleFrontEnd,          /* Other bubbles: pipeline fill, JAL redirects, fetch stopped at halt */
+	CycleHalted,            /* The core halted while others ran, counted by the computer */
+	NumCycleBuckets
+} CycleBucket;
+
+/* Bypass paths of the forwarding network, named by producer and consumer stage */
+typedef enum { ForwardEXEX = 0, ForwardMEMEX, ForwardWBID, NumForwardPaths } ForwardPath;
+
+typedef struct 
+{
+	instruction_type type;
+	opcode op;
+	int rs, rt, rd;
+	bool hasImm;
+	int imm;
+	int rsData, rtData, rdData;
+	bool isHalt;
+} Instruction;
+
+typedef struct
+{
+	bool valid;
+	int data;
+	int addr;
+	int pc;                 // Address the instruction was fetched from
+	bool predictedTaken;    // IF fetched the BTB target after this branch
+	bool memDone;           // MEM has accessed the cache, the other slot of the pair missed
+	CycleBucket bubbleCause; // Why the slot holds a bubble
+	Instruction inst;
+} StageInstruction;
+
+typedef struct
+{
+	bool stalled;
+	bool stallNextCycle;
+	bool delayedWrite;
+	int delayedWriteReg;
+	int delayedWriteData;
+	bool pairDelayedWrite;  // Write of the younger instruction of a dual-issue pair
+	int pairDelayedWriteReg;
+	int pairDelayedWriteData;
+} StageStatus;
+
+/* Parsed program of one core. A program is only read by the pipelines
+   executing it, so one image may be shared by any number of computers.
+   The instructions are either allocated by the assembler (see Assembler.h)
+   or mapped from a pre-assembled image file (see ProgramImage.h). */
+struct Program_
+{
+	Instruction* instructions;
+	int numInstructions;
+	int capacity;           /* Allocated instructions */
+	int haltIndex;
+	void* mapping;          /* Mapped image file, NULL for parsed programs */
+	size_t mappingSize;
+};
+typedef struct Program_* Program;
+
+struct MSIBus;
+struct PCProfile_;
+struct Pipeline
+{
+	struct MSIBus_* bus;
+	Cache cache;
+	int registers[NUM_REGS];
+	const Instruction* instruction_mem;
+
+	/* Instructions in each of the stages */
+	StageInstruction stageInst[NumStages];
+	/* Younger instruction of each stage in dual-issue mode, bubbles otherwise */
+	StageInstruction pairInst[NumStages];
+	int issueWidth;         // Instructions fetched and issued per cycle, 1 or 2
+	int fetchSlot;          // First ID latch slot IF fills, ID keeps an unpaired instruction in slot 0
+
+	/* Stage status */
+	StageStatus stageStat[NumStages];
+
+	int dataHazardStallCycles;
+	bool stalledDataHazard;
+	bool forwarding;        // Bypass results to dependent instructions, False stalls until write back
+	BranchPredictor predictor; // Owned by the pipeline, NULL fetches sequentially
+	StoreBuffer storeBuffer;   // Owned by the pipeline, NULL performs stores in MEM
+	bool storeBufferWait;      // MEM is frozen until the store buffer drains, not for the bus
+	SharingTracker sharing;    // Shared by the computer's pipelines, NULL records no accesses
+	struct PCProfile_* pcProfile; // Shared by the computer's pipelines, NULL profiles no instructions
+	StackDistance stackDistance;  // Shared by the computer's pipelines, NULL records no references
+	ShadowBank shadows;           // Shared by the computer's pipelines, NULL looks up no shadow caches
+	bool flushBranchFlag;
+	bool branchTaken;
+	bool totally_done;      // True when halt has propagated through the pipeline
+	bool faulted;           // Stopped on an invalid instruction instead of a halt, the run failed
+	bool interactive_mode;  // If True, print registers after each Instruction, wait for enter to be pressed
+
+	int PC;
+	int haltIndex;
+	int totalCycles;
+	int ifUtil;
+	int idUtil;
+	int exUtil;
+	int memUtil;
+	int wbUtil;
+	int dataStallCycles;    // Cycles ID held an instruction for a data hazard
+	int loadUseStallCycles; // Of those, cycles waiting for a load with forwarding on
+	int stallCyclesAvoided; // Data hazard cycles stall-only would have added
+	int forwards[NumForwardPaths];
+	int branches;           // Conditional branches resolved in ID
+	int mispredictions;
+	int flushCycles;        // Bubbles fetched after mispredicted branches
+	int pairedIssues;       // Cycles ID issued two instructions
+	int bufferedStores;     // Stores retired into the store buffer
+	int storeForwards;      // Loads served by the store buffer
+	int storeBufferStalls;  // Cycles MEM waited for the store buffer to drain
+	int storeCyclesHidden;  // Cycles buffered stores waited for their block while the core ran on
+	int fastForwarded;      // Instructions executed functionally before the pipeline started
+	int cycleBuckets[NumCycleBuckets]; // CPI stack, the buckets add up to the computer's cycles
+	CycleBucket cycleBucket; // Bucket of the current cycle, set in WB
+	bool scRetry;           // An SC failed and no SC of the core has succeeded since
+	opcode statsControls[2]; // Statistics control instructions written back this cycle, oldest first
+	int numStatsControls;   // The computer handles them after the cycle and clears them
+};
+typedef struct Pipeline Pipeline;
+typedef struct Pipeline* PipelinePtr;
+
+Pipeline* createPipeline();
+void destroyPipeline(Pipeline* pipe);
+void initializePipeline(Pipeline* pipe, Program prog, struct MSIBus_* bus, Cache cache);
+
+Program createProgram();
+void destroyProgram(Program prog);
+// Load an assembly file or a pre-assembled image into a new program,
+// NULL if the file cannot be read
+Program loadProgram(char* fileName);
+// Assemble a file into the program, returns 0 on errors
+int progScanner( Program prog, char* filename );
+// Assemble a program held in memory, lines separated by '\n'
+int progTextScanner( Program prog, const char* text );
+opcode stringToOpcode(char* opcode);
+bool isRegularType(opcode opc);
+bool isJal(opcode opc);
+bool isBranch(opcode opc);
+bool isStore(opcode opc);
+bool isLoad(opcode opc);
+bool isHalt(opcode opc);
+bool isFence(opcode opc);
+bool isStatsControl(opcode opc);
+bool isAtomic(opcode opc);
+bool hasMemoryResult(opcode opc);
+bool writesRegister(const Instruction* inst, int reg);
+bool isBranchTaken(opcode op, int rsData, int rtData);
+void applyDelayedWrites(Pipeline* pipe);
+StageInstruction* getSlot(Pipeline* pipe, Stage st, int slot);
+bool canPairInstructions(Pipeline* pipe, const Instruction* older, const Instruction* younger);
+// Data hazards of an instruction in ID, the register it waits for or -1
+int checkHazard( Pipeline* pipe, const Instruction* inst );
+int checkHazardRegister(Pipeline* pipe, const Instruction* inst, int reg);
+// Hazards left with forwarding: load-use, and branches resolved in ID
+// waiting for a result that only reaches ID through WB
+int checkForwardHazard( Pipeline* pipe, const Instruction* inst );
+int checkForwardHazardRegister(Pipeline* pipe, const Instruction* inst, int reg);
+int checkIssueHazard(Pipeline* pipe, const Instruction* inst);
+int findProducer(Pipeline* pipe, int reg, const Instruction** producer, int* value);
+// Value of a source register read in ID, bypassed from a later stage when
+// forwarding is on. *legacyStall is raised to the cycles stall-only would wait.
+int readForwardedRegister(Pipeline* pipe, int reg, int* legacyStall);
+
+// Write the oldest buffered store to the cache, or ask the bus for its block
+void drainStoreBuffer(Pipeline* pipe);
+
+void runPipelineOneCycle(Pipeline* pipe);
+// Stop the core on an invalid instruction, reported on stderr, rather than abort the host
+void faultPipeline(Pipeline* pipe, const StageInstruction* slot, const char* reason);
+void runPipelineFully(Pipeline* pipe);
+// Put all stages in stall mode and wait
+// The initiator of the stall is Stage st
+void freezePipeline(Pipeline *pipe, Stage st);
+// Unfreeze pipeline
+void unfreezePipeline( Pipeline* pipe );
+
+void printStatistics( Pipeline* pipe );
+// Print the cycles and CPI of each bucket, cycles is the computer's cycles
+void printCPIStack(FILE* out, const char* name, const int buckets[], int cycles, int instructions);
+const char* getCycleBucketName(CycleBucket bucket);
+// Register the utilization and stall counters under prefix
+void registerPipelineStats(Pipeline* pipe, StatsRegistry reg, const char* prefix);
+void printRegisters ( Pipeline* pipe );
+
+//Stage declarations
+void IF ( Pipeline* pipe );
+void ID ( Pipeline* pipe );
+void EX ( Pipeline* pipe );
+void MEM( Pipeline* pipe );
+void WB ( Pipeline* pipe );
+
+#endif
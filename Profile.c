@@ -0,0 +1,97 @@
+#include "Profile.h"
+
+#ifdef SIM_PROFILE
+
+#include <pthread.h>
+#include <time.h>
+
+__thread ProfileThread profileThread = NULL;
+__thread struct ProfileThread_ unprofiledThread;
+
+static const char* regionNames[NumProfileRegions] =
+{
+	"runComputer", "runPipelineOneCycle", "IF", "ID", "EX", "MEM", "WB",
+	"checkHazard", "drainStoreBuffer", "readFromCache", "writeToCache", "addBlockToCache",
+	"findBlock", "getIndexTag", "advanceMSIBusClock", "busRd", "busRdX", "advanceMemoryClock"
+};
+
+static pthread_mutex_t profileLock = PTHREAD_MUTEX_INITIALIZER;
+static ProfileThread profileThreads = NULL;
+static unsigned long long startTicks;  /* Clock and wall time of the first registration, */
+static double startSeconds;            /* together they convert ticks to seconds */
+
+static double profileWallTime()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+ProfileThread registerProfileThread()
+{
+	ProfileThread thread = (ProfileThread)calloc(1, sizeof(struct ProfileThread_));
+
+	if (thread == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for the profile, a thread is not profiled.\n");
+		return NULL;
+	}
+
+	pthread_mutex_lock(&profileLock);
+	if (profileThreads == NULL)
+	{
+		startSeconds = profileWallTime();
+		startTicks = readProfileClock();
+		atexit(printProfile);
+	}
+	thread->next = profileThreads;
+	profileThreads = thread;
+	pthread_mutex_unlock(&profileLock);
+
+	profileThread = thread;
+	return thread;
+}
+
+void printProfile()
+{
+	ProfileCounter total[NumProfileRegions] = { { 0, 0 } };
+	unsigned long long cycles = 0;
+	double ticksPerSecond, seconds, loopSeconds;
+	ProfileThread thread;
+	int i, numThreads = 0;
+
+	pthread_mutex_lock(&profileLock);
+	seconds = profileWallTime() - startSeconds;
+	ticksPerSecond = (seconds > 0) ? (readProfileClock() - startTicks) / seconds : 1e9;
+	for (thread = profileThreads; thread != NULL; thread = thread->next)
+	{
+		for (i = 0; i < NumProfileRegions; i++)
+		{
+			total[i].ticks += thread->counters[i].ticks;
+			total[i].calls += thread->counters[i].calls;
+		}
+		cycles += thread->simulatedCycles;
+		numThreads++;
+	}
+	pthread_mutex_unlock(&profileLock);
+
+	loopSeconds = total[ProfileRunComputer].ticks / ticksPerSecond;
+	fprintf(stderr, "\nHost profile, %d thread%s, %.3f s wall\n", numThreads, numThreads == 1 ? "" : "s", seconds);
+	fprintf(stderr, "%-22s %12s %10s %8s %10s\n", "region", "calls", "seconds", "loop%", "ns/call");
+	for (i = 0; i < NumProfileRegions; i++)
+	{
+		double regionSeconds = total[i].ticks / ticksPerSecond;
+
+		if (total[i].calls == 0)
+			continue;
+		fprintf(stderr, "%-22s %12llu %10.4f %7.1f%% %10.1f\n", regionNames[i], total[i].calls, regionSeconds,
+			loopSeconds > 0 ? 100.0 * regionSeconds / loopSeconds : 0.0, 1e9 * regionSeconds / total[i].calls);
+	}
+	fprintf(stderr, "Simulated cycles: %llu", cycles);
+	if (loopSeconds > 0)
+		fprintf(stderr, ", %.0f per second of runComputer", cycles / loopSeconds);
+	fprintf(stderr, "\n");
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "Shared.h"
+
+/* Host time profile of the simulator itself
+ *
+ * Built only with -DSIM_PROFILE, otherwise every macro below expands to
+ * nothing. PROFILE_SCOPE(region) at the end of the declarations of a block
+ * times the rest of the block, including early returns. Each thread adds its
+ * ticks to its own counters, so sweep threads do not contend; all threads are
+ * summed into a breakdown on stderr when the program exits. Regions nest, so
+ * a stage's time also counts in the runComputer loop that called it.
+ */
+
+typedef enum
+{
+	ProfileRunComputer = 0, ProfilePipelineCycle, ProfileIF, ProfileID, ProfileEX, ProfileMEM, ProfileWB,
+	ProfileCheckHazard, ProfileStoreBuffer, ProfileReadCache, ProfileWriteCache, ProfileAddBlock,
+	ProfileFindBlock, ProfileGetIndexTag, ProfileBusClock, ProfileBusRd, ProfileBusRdX, ProfileMemoryClock,
+	NumProfileRegions
+} ProfileRegion;
+
+#ifdef SIM_PROFILE
+
+typedef struct
+{
+	unsigned long long ticks;
+	unsigned long long calls;
+} ProfileCounter;
+
+struct ProfileThread_
+{
+	ProfileCounter counters[NumProfileRegions];
+	unsigned long long simulatedCycles;
+	struct ProfileThread_* next;
+};
+typedef struct ProfileThread_* ProfileThread;
+
+typedef struct
+{
+	ProfileRegion region;
+	unsigned long long start;
+} ProfileScope;
+
+extern __thread ProfileThread profileThread;
+extern __thread struct ProfileThread_ unprofiledThread;  /* Counters of a thread that could not register, never printed */
+
+// Counters of the calling thread, allocated and linked on first use, NULL when out of memory
+ProfileThread registerProfileThread();
+// Print the breakdown of all threads, registered with atexit
+void printProfile();
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static inline unsigned long long readProfileClock() { return __rdtsc(); }
+#else
+#include <time.h>
+static inline unsigned long long readProfileClock()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+#endif
+
+// Register the calling thread on first use, or leave it unprofiled when that fails
+static inline void enterProfileThread()
+{
+	if (profileThread == NULL && registerProfileThread() == NULL)
+		profileThread = &unprofiledThread;
+}
+
+static inline ProfileScope beginProfileScope(ProfileRegion region)
+{
+	ProfileScope scope;
+
+	enterProfileThread();
+	scope.region = region;
+	scope.start = readProfileClock();
+	return scope;
+}
+
+static inline void endProfileScope(ProfileScope* scope)
+{
+	ProfileCounter* counter = &profileThread->counters[scope->region];
+
+	counter->ticks += readProfileClock() - scope->start;
+	counter->calls++;
+}
+
+#define PROFILE_SCOPE(region) \
+	ProfileScope profileScope __attribute__((cleanup(endProfileScope))) = beginProfileScope(region)
+#define PROFILE_CYCLES(n) \
+	do { enterProfileThread(); profileThread->simulatedCycles += (n); } while (0)
+
+#else
+
+#define PROFILE_SCOPE(region)
+#define PROFILE_CYCLES(n)
+
+#endif
+
+#endif
@@ -0,0 +1,188 @@
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "ProgramImage.h"
+
+#define FNV_OFFSET_BASIS 2166136261u
+#define FNV_PRIME        16777619u
+
+unsigned int programChecksum(const Instruction* instructions, int numInstructions)
+{
+	const unsigned char* bytes = (const unsigned char*)instructions;
+	size_t i, size = (size_t)numInstructions * sizeof(Instruction);
+	unsigned int hash = FNV_OFFSET_BASIS;
+
+	for (i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= FNV_PRIME;
+	}
+	return hash;
+}
+
+int findInvalidInstruction(const Instruction* instructions, int numInstructions)
+{
+	const Instruction* inst;
+	int i;
+
+	for (i = 0; i < numInstructions; i++)
+	{
+		inst = &instructions[i];
+		if (inst->op < 0 || inst->op >= NUM_OPCODES || inst->type < Reg || inst->type > CTL)
+			return i;
+		if (inst->rs < -1 || inst->rs >= NUM_REGS || inst->rt < -1 || inst->rt >= NUM_REGS ||
+			inst->rd < -1 || inst->rd >= NUM_REGS)
+			return i;
+		if (inst->rd == 1 && inst->type != B && inst->type != J)
+			return i;
+		if ((inst->type == B || inst->type == J) && (inst->imm < 0 || inst->imm >= numInstructions))
+			return i;
+	}
+	return -1;
+}
+
+int writeProgramImage(Program prog, char* fileName)
+{
+	ProgramImageHeader header;
+	FILE* out = fopen(fileName, "wb");
+
+	if (out == NULL)
+	{
+		fprintf(stderr, "Could not open program image %s.\n", fileName);
+		return 0;
+	}
+
+	/* Clear the padding so images of the same program are identical */
+	memset(&header, 0, sizeof(header));
+	header.magic = PROGRAM_IMAGE_MAGIC;
+	header.version = PROGRAM_IMAGE_VERSION;
+	header.recordSize = sizeof(Instruction);
+	header.numInstructions = (unsigned int)prog->numInstructions;
+	header.haltIndex = prog->haltIndex;
+	header.checksum = programChecksum(prog->instructions, prog->numInstructions);
+	header.byteOrder = PROGRAM_IMAGE_BYTE_ORDER;
+
+	if (fwrite(&header, sizeof(header), 1, out) != 1 ||
+		fwrite(prog->instructions, sizeof(Instruction), prog->numInstructions, out) != (size_t)prog->numInstructions)
+	{
+		fprintf(stderr, "Could not write program image %s.\n", fileName);
+		fclose(out);
+		return 0;
+	}
+
+	fclose(out);
+	return 1;
+}
+
+// A word as a host of the other byte order reads it
+unsigned int swapImageWord(unsigned int word)
+{
+	return (word >> 24) | ((word >> 8) & 0xFF00) | ((word << 8) & 0xFF0000) | (word << 24);
+}
+
+bool isProgramImage(char* fileName)
+{
+	unsigned int magic = 0;
+	FILE* in = fopen(fileName, "rb");
+
+	if (in == NULL)
+		return False;
+	if (fread(&magic, sizeof(magic), 1, in) != 1)
+		magic = 0;
+	fclose(in);
+
+	return (magic == PROGRAM_IMAGE_MAGIC || magic == swapImageWord(PROGRAM_IMAGE_MAGIC)) ? True : False;
+}
+
+Program mapProgramImage(char* fileName, bool verifyChecksum)
+{
+	int fd;
+	struct stat st;
+	void* mapping;
+	const ProgramImageHeader* header;
+	Program prog;
+	int invalid;
+
+	fd = open(fileName, O_RDONLY);
+	if (fd < 0)
+	{
+		fprintf(stderr, "Could not open program image %s.\n", fileName);
+		return NULL;
+	}
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ProgramImageHeader))
+	{
+		fprintf(stderr, "Program image %s is truncated.\n", fileName);
+		close(fd);
+		return NULL;
+	}
+
+	mapping = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED)
+	{
+		fprintf(stderr, "Could not map program image %s.\n", fileName);
+		return NULL;
+	}
+
+	/* Validate the header against this host */
+	header = (const ProgramImageHeader*)mapping;
+	if (header->magic == swapImageWord(PROGRAM_IMAGE_MAGIC) || header->byteOrder == swapImageWord(PROGRAM_IMAGE_BYTE_ORDER))
+	{
+		fprintf(stderr, "Program image %s was written on a host of the other byte order.\n", fileName);
+		munmap(mapping, (size_t)st.st_size);
+		return NULL;
+	}
+	if (header->magic != PROGRAM_IMAGE_MAGIC || header->version != PROGRAM_IMAGE_VERSION ||
+		header->byteOrder != PROGRAM_IMAGE_BYTE_ORDER || header->recordSize != sizeof(Instruction) ||
+		(size_t)st.st_size != sizeof(ProgramImageHeader) + (size_t)header->numInstructions * sizeof(Instruction) ||
+		header->haltIndex < 0 || (header->numInstructions > 0 && (unsigned int)header->haltIndex >= header->numInstructions))
+	{
+		fprintf(stderr, "Program image %s was not written for this simulator build.\n", fileName);
+		munmap(mapping, (size_t)st.st_size);
+		return NULL;
+	}
+
+	if (verifyChecksum &&
+		programChecksum((const Instruction*)(header + 1), (int)header->numInstructions) != header->checksum)
+	{
+		fprintf(stderr, "Program image %s is corrupted.\n", fileName);
+		munmap(mapping, (size_t)st.st_size);
+		return NULL;
+	}
+
+	/* The records are run as they are, so one the assembler would reject fails the image */
+	invalid = findInvalidInstruction((const Instruction*)(header + 1), (int)header->numInstructions);
+	if (invalid >= 0)
+	{
+		fprintf(stderr, "Program image %s has an invalid instruction at %d.\n", fileName, invalid);
+		munmap(mapping, (size_t)st.st_size);
+		return NULL;
+	}
+
+	prog = (Program)malloc(sizeof(struct Program_));
+	if (prog == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for program.\n");
+		munmap(mapping, (size_t)st.st_size);
+		return NULL;
+	}
+
+	/* The pipelines only read the instructions, so they run from the mapping */
+	prog->instructions = (Instruction*)(header + 1);
+	prog->numInstructions = (int)header->numInstructions;
+	prog->capacity = (int)header->numInstructions;
+	prog->haltIndex = header->haltIndex;
+	prog->mapping = mapping;
+	prog->mappingSize = (size_t)st.st_size;
+
+	return prog;
+}
+
+void unmapProgramImage(Program prog)
+{
+	munmap(prog->mapping, prog->mappingSize);
+	prog->mapping = NULL;
+	prog->instructions = NULL;
+}
@@ -0,0 +1,56 @@
+#ifndef PROGRAM_IMAGE_H
+#define PROGRAM_IMAGE_H
+
+#include "Shared.h"
+#include "Pipeline2.h"
+
+/* Pre-assembled program image
+ *
+ * An image is a header followed by the decoded Instruction records exactly
+ * as the simulator holds them in memory, so loading it is a single mmap
+ * with no parsing. The records are host specific: the header records the
+ * record size and byte order of the writer and images from another layout
+ * are rejected, those of the other byte order with a message saying so.
+ *
+ *  ------------------------------------------------------------
+ * | Header (32 bytes) | Instruction 0 | ... | Instruction n-1   |
+ *  ------------------------------------------------------------
+ */
+
+#define PROGRAM_IMAGE_MAGIC   0x4D49534D   /* "MSIM" */
+#define PROGRAM_IMAGE_VERSION 2
+#define PROGRAM_IMAGE_BYTE_ORDER 0x01020304 /* Reads as 0x04030201 on a host of the other byte order */
+
+typedef struct
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int recordSize;        /* sizeof(Instruction) of the writer */
+	unsigned int numInstructions;
+	int haltIndex;
+	unsigned int checksum;          /* FNV-1a of the instruction records */
+	unsigned int byteOrder;         /* PROGRAM_IMAGE_BYTE_ORDER in the writer's byte order */
+	unsigned int reserved;          /* Keeps the records 8 byte aligned */
+} ProgramImageHeader;
+
+/* Write a parsed program as an image, returns 1 on success */
+int writeProgramImage(Program prog, char* fileName);
+
+/* True when the file starts with the image magic in either byte order */
+bool isProgramImage(char* fileName);
+
+/* Map an image read only and return a program using the mapped records.
+   Returns NULL when the file is not a valid image for this host. */
+Program mapProgramImage(char* fileName, bool verifyChecksum);
+
+/* Release the mapping of a program returned by mapProgramImage */
+void unmapProgramImage(Program prog);
+
+unsigned int programChecksum(const Instruction* instructions, int numInstructions);
+
+/* Index of the first record the pipelines cannot run: an unknown opcode or type,
+   a register out of range, a write to R1 or a branch target outside the program.
+   Returns -1 when every record is valid. */
+int findInvalidInstruction(const Instruction* instructions, int numInstructions);
+
+#endif
@@ -0,0 +1,170 @@
+#include <string.h>
+#include "ShadowCache.h"
+#include "Memory.h"
+
+ShadowBank createShadowBank(const int sizes[], const int associativities[], int numCaches)
+{
+	ShadowBank bank;
+	ShadowCache* cache;
+	bool allocated;
+	int k, i;
+
+	if (numCaches < 1 || numCaches > MAX_SHADOW_CACHES)
+	{
+		fprintf(stderr, "There must be between 1 and %d shadow caches.\n", MAX_SHADOW_CACHES);
+		return NULL;
+	}
+	for (k = 0; k < numCaches; k++)
+		if (associativities[k] < 1 || associativities[k] > MAX_SHADOW_ASSOCIATIVITY || sizes[k] < associativities[k] ||
+			sizes[k] % associativities[k] != 0 || ((sizes[k] / associativities[k]) & (sizes[k] / associativities[k] - 1)) != 0)
+		{
+			fprintf(stderr, "Shadow cache of %d blocks and %d ways has no power of two sets.\n", sizes[k], associativities[k]);
+			return NULL;
+		}
+
+	if ((bank = (ShadowBank)calloc(1, sizeof(struct ShadowBank_))) == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for the shadow caches.\n");
+		return NULL;
+	}
+	bank->numCaches = numCaches;
+	bank->versions = (int*)calloc(MEM_SIZE, sizeof(int));
+	bank->readers = (unsigned char*)calloc(MEM_SIZE, sizeof(unsigned char));
+	allocated = (bank->versions != NULL && bank->readers != NULL);
+	for (k = 0; k < numCaches; k++)
+	{
+		cache = &bank->caches[k];
+		cache->size = sizes[k];
+		cache->associativity = associativities[k];
+		cache->numSets = sizes[k] / associativities[k];
+		for (i = 0; i < NUM_CORES; i++)
+		{
+			cache->tags[i] = (int*)calloc(sizes[k], sizeof(int));
+			cache->stamps[i] = (int*)calloc(sizes[k], sizeof(int));
+			if (cache->tags[i] == NULL || cache->stamps[i] == NULL)
+				allocated = False;
+		}
+	}
+	if (!allocated)
+	{
+		fprintf(stderr, "Could not allocate memory for the shadow caches.\n");
+		destroyShadowBank(bank);
+		return NULL;
+	}
+	return bank;
+}
+
+void destroyShadowBank(ShadowBank bank)
+{
+	int k, i;
+
+	if (bank == NULL)
+		return;
+
+	for (k = 0; k < bank->numCaches; k++)
+		for (i = 0; i < NUM_CORES; i++)
+		{
+			free(bank->caches[k].tags[i]);
+			free(bank->caches[k].stamps[i]);
+		}
+	free(bank->versions);
+	free(bank->readers);
+	free(bank);
+}
+
+// Way of a set holding tag, associativity when absent. Tags are unique in a
+// set, so every way is compared and the loop has no branch to leave early.
+int findShadowWay(const int* set, int associativity, int tag)
+{
+	int way, found = associativity;
+
+	for (way = 0; way < associativity; way++)
+		found -= (set[way] == tag) * (associativity - way);
+	return found;
+}
+
+void recordShadowAccess(ShadowBank bank, int core, int block, bool write)
+{
+	ShadowCache* cache;
+	int* set;
+	int* stamps;
+	int version, offset, way, stamp, k;
+	bool sharedByOthers;
+
+	if (block < 0 || block >= MEM_SIZE)
+		return;
+	version = bank->versions[block];
+	sharedByOthers = (bank->readers[block] & ~(1 << core)) != 0;
+
+	for (k = 0; k < bank->numCaches; k++)
+	{
+		cache = &bank->caches[k];
+		offset = (block & (cache->numSets - 1)) * cache->associativity;
+		set = cache->tags[core] + offset;
+		stamps = cache->stamps[core] + offset;
+		way = findShadowWay(set, cache->associativity, block + 1);
+
+		if (way == cache->associativity)
+		{
+			cache->misses++;
+			way--;          // Replace the least recently used way
+			stamp = version * 2;
+		}
+		else if ((stamps[way] >> 1) == version && (!write || ((stamps[way] & 1) && !sharedByOthers)))
+		{
+			cache->hits++;
+			stamp = stamps[way];
+		}
+		else
+		{
+			cache->misses++;
+			cache->coherenceMisses++;
+			stamp = version * 2;
+		}
+		if (write)
+			stamp = (version + 1) * 2 + 1;
+
+		memmove(set + 1, set, way * sizeof(int));
+		memmove(stamps + 1, stamps, way * sizeof(int));
+		set[0] = block + 1;
+		stamps[0] = stamp;
+	}
+
+	if (write)
+	{
+		bank->versions[block]++;
+		bank->readers[block] = 0;
+	}
+	else
+		bank->readers[block] |= 1 << core;
+}
+
+void registerShadowStats(ShadowBank bank, StatsRegistry reg)
+{
+	char prefix[32];
+	int k;
+
+	for (k = 0; k < bank->numCaches; k++)
+	{
+		sprintf(prefix, "shadow%dx%d", bank->caches[k].size, bank->caches[k].associativity);
+		registerCounter(reg, prefix, "hits", &bank->caches[k].hits);
+		registerCounter(reg, prefix, "misses", &bank->caches[k].misses);
+		registerCounter(reg, prefix, "coherenceMisses", &bank->caches[k].coherenceMisses);
+	}
+}
+
+void printShadowReport(ShadowBank bank, FILE* out)
+{
+	ShadowCache* cache;
+	int k, accesses;
+
+	fprintf(out, "Shadow caches, all cores\n");
+	fprintf(out, "%8s %5s %10s %10s %10s %8s\n", "blocks", "ways", "hits", "misses", "coherence", "missRate");
+	for (k = 0; k < bank->numCaches; k++)
+	{
+		cache = &bank->caches[k];
+		accesses = cache->hits + cache->misses;
+		fprintf(out, "%8d %5d %10d %10d %10d %8.4f\n", cache->size, cache->associativity, cache->hits, cache->misses,
+			cache->coherenceMisses, (accesses > 0) ? (double)cache->misses / accesses : 0.0);
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef SHADOW_CACHE_H
+#define SHADOW_CACHE_H
+
+#include "Shared.h"
+#include "Stats.h"
+
+#define MAX_SHADOW_CACHES 64
+#define MAX_SHADOW_ASSOCIATIVITY 64
+
+/* Shadow caches
+ *
+ * A bank of tag arrays of other cache geometries that see the same
+ * references as the primary caches, so one run evaluates dozens of
+ * geometries. They hold no data and never stall a pipeline: the timing is
+ * the primary caches' alone.
+ *
+ * Every access completed in MEM is looked up in the core's tag array of each
+ * geometry. Ways are kept most recently used first and compared without
+ * branches, so the compare of a set is a straight loop over its ways. Each
+ * block has a write version: a way remembers the version it was filled at
+ * and whether its core wrote it, so a write by another core invalidates the
+ * copies of every geometry at once. A write hits only a copy its core wrote
+ * that no other core read since, as MSI would need an upgrade otherwise.
+ */
+
+typedef struct
+{
+	int size;               /* Blocks */
+	int associativity;
+	int numSets;
+	int* tags[NUM_CORES];   /* Block + 1 of each way, set after set, 0 = empty */
+	int* stamps[NUM_CORES]; /* Write version at fill times 2, plus 1 when the core wrote it */
+	int hits;
+	int misses;
+	int coherenceMisses;    /* Misses of a block still in its set: written by another core, or shared */
+} ShadowCache;
+
+struct ShadowBank_
+{
+	ShadowCache caches[MAX_SHADOW_CACHES];
+	int numCaches;
+	int* versions;          /* Writes to each block */
+	unsigned char* readers; /* Cores that read each block since its last write, a bit each */
+};
+typedef struct ShadowBank_* ShadowBank;
+
+// sizes are in blocks, each a power of two divisible by its associativity, NULL on errors
+ShadowBank createShadowBank(const int sizes[], const int associativities[], int numCaches);
+void destroyShadowBank(ShadowBank bank);
+
+// Look up a reference of core in every geometry and update their LRU order
+void recordShadowAccess(ShadowBank bank, int core, int block, bool write);
+
+// Register the counters of each geometry as shadow<size>x<ways>.hits ...
+void registerShadowStats(ShadowBank bank, StatsRegistry reg);
+
+// Print hits and misses of every geometry
+void printShadowReport(ShadowBank bank, FILE* out);
+
+#endif
@@ -1,11 +1,11 @@
-#ifndef SHARED_H
-#define SHARED_H
-
-#include <stdio.h>
-#include <stdlib.h>
-
-#define NUM_CORES 4
-
-typedef enum { False, True } bool;
-
-#endif
+#ifndef SHARED_H
+#define SHARED_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define NUM_CORES 4
+
+typedef enum { False, True } bool;
+
+#endif
@@ -0,0 +1,255 @@
+#include <string.h>
+#include "Sharing.h"
+#include "Memory.h"
+
+#define INITIAL_SHARING_LINES 256
+
+static const char* sharingClassNames[NumSharingClasses] =
+{
+	"private", "read-only", "migratory", "producer-consumer", "false-sharing", "read-write"
+};
+
+SharingTracker createSharingTracker(int lineWords)
+{
+	SharingTracker tracker;
+	int shift = 0;
+
+	while ((1 << shift) < lineWords)
+		shift++;
+	if (lineWords < 1 || lineWords > MAX_SHARING_LINE_WORDS || (1 << shift) != lineWords)
+	{
+		fprintf(stderr, "Sharing analysis lines must be a power of two up to %d words.\n", MAX_SHARING_LINE_WORDS);
+		return NULL;
+	}
+
+	if ((tracker = (SharingTracker)malloc(sizeof(struct SharingTracker_))) == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for the sharing analysis.\n");
+		return NULL;
+	}
+	tracker->lineWords = lineWords;
+	tracker->lineShift = shift;
+	tracker->lineIndex = (int*)calloc(MEM_SIZE >> shift, sizeof(int));
+	tracker->capacity = INITIAL_SHARING_LINES;
+	tracker->lines = (SharingLine*)malloc(tracker->capacity * sizeof(SharingLine));
+	tracker->numLines = 0;
+	if (tracker->lineIndex == NULL || tracker->lines == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for the sharing analysis.\n");
+		destroySharingTracker(tracker);
+		return NULL;
+	}
+	return tracker;
+}
+
+void destroySharingTracker(SharingTracker tracker)
+{
+	if (tracker == NULL)
+		return;
+
+	free(tracker->lineIndex);
+	free(tracker->lines);
+	free(tracker);
+}
+
+// Line of an address, added on its first access. NULL when out of memory.
+SharingLine* getSharingLine(SharingTracker tracker, int addr)
+{
+	int line = addr >> tracker->lineShift;
+	SharingLine* lines;
+
+	if (tracker->lineIndex[line] != 0)
+		return &tracker->lines[tracker->lineIndex[line] - 1];
+
+	if (tracker->numLines == tracker->capacity)
+	{
+		if ((lines = (SharingLine*)realloc(tracker->lines, 2 * tracker->capacity * sizeof(SharingLine))) == NULL)
+			return NULL;
+		tracker->lines = lines;
+		tracker->capacity *= 2;
+	}
+	memset(&tracker->lines[tracker->numLines], 0, sizeof(SharingLine));
+	tracker->lines[tracker->numLines].line = line;
+	tracker->lines[tracker->numLines].owner = -1;
+	tracker->lines[tracker->numLines].lastWriter = -1;
+	tracker->lineIndex[line] = ++tracker->numLines;
+	return &tracker->lines[tracker->numLines - 1];
+}
+
+// Count a coherence event against the instruction that caused it. A full
+// table gives the slot of the least frequent instruction to the new one.
+void countSharingPC(SharingLine* line, int core, int pc)
+{
+	SharingPC* least = &line->pcs[0];
+	int i;
+
+	for (i = 0; i < MAX_SHARING_PCS; i++)
+	{
+		if (line->pcs[i].events > 0 && line->pcs[i].core == core && line->pcs[i].pc == pc)
+		{
+			line->pcs[i].events++;
+			return;
+		}
+		if (line->pcs[i].events < least->events)
+			least = &line->pcs[i];
+	}
+	least->core = core;
+	least->pc = pc;
+	least->events++;
+}
+
+void recordSharingAccess(SharingTracker tracker, int core, int pc, int addr, bool write)
+{
+	SharingLine* line;
+	unsigned int word, self = 1u << core;
+	int i;
+
+	if (addr < 0 || addr >= MEM_SIZE || (line = getSharingLine(tracker, addr)) == NULL)
+		return;
+	word = 1u << (addr & (tracker->lineWords - 1));
+
+	if (!write)
+	{
+		line->reads[core]++;
+		line->readWords[core] |= word;
+		if (line->owner >= 0 && line->owner != core)
+		{
+			line->transfers++;
+			countSharingPC(line, core, pc);
+			line->owner = -1;
+		}
+		if ((line->holders & self) == 0)
+			line->touchedWords[core] = 0;
+		line->holders |= self;
+		line->touchedWords[core] |= word;
+		line->readersSinceWrite |= self;
+		return;
+	}
+
+	line->writes[core]++;
+	line->writeWords[core] |= word;
+	if (line->owner != core)
+	{
+		for (i = 0; i < NUM_CORES; i++)
+			if (i != core && (line->holders & (1u << i)))
+			{
+				line->invalidations++;
+				if ((line->touchedWords[i] & word) == 0)
+					line->falseInvalidations++;
+				countSharingPC(line, core, pc);
+			}
+		if ((line->holders & self) == 0)
+			line->touchedWords[core] = 0;
+		line->holders = self;
+		line->owner = core;
+	}
+	if (line->lastWriter >= 0 && line->lastWriter != core && (line->readersSinceWrite & self))
+		line->handoffs++;
+	line->lastWriter = core;
+	line->readersSinceWrite = 0;
+	line->touchedWords[core] |= word;
+}
+
+SharingClass classifySharingLine(const SharingLine* line)
+{
+	int i, accessors = 0, writers = 0;
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		accessors += (line->reads[i] + line->writes[i] > 0);
+		writers += (line->writes[i] > 0);
+	}
+
+	if (accessors <= 1)
+		return SharingPrivate;
+	if (writers == 0)
+		return SharingReadOnly;
+	if (2 * line->falseInvalidations > line->invalidations)
+		return SharingFalse;
+	if (writers > 1 && line->handoffs > 0 && 2 * line->handoffs >= line->invalidations)
+		return SharingMigratory;
+	if (writers == 1)
+		return SharingProducerConsumer;
+	return SharingReadWrite;
+}
+
+const char* getSharingClassName(SharingClass sharingClass)
+{
+	return sharingClassNames[sharingClass];
+}
+
+// Order of the report, most invalidations and transfers first
+int compareSharingLines(const void* a, const void* b)
+{
+	const SharingLine* x = *(const SharingLine* const*)a;
+	const SharingLine* y = *(const SharingLine* const*)b;
+	int dx = x->invalidations + x->transfers, dy = y->invalidations + y->transfers;
+
+	if (dx != dy)
+		return dy - dx;
+	return x->line - y->line;
+}
+
+int compareSharingPCs(const void* a, const void* b)
+{
+	return ((const SharingPC*)b)->events - ((const SharingPC*)a)->events;
+}
+
+void printSharingReport(SharingTracker tracker, FILE* out, int maxLines)
+{
+	SharingPC pcs[MAX_SHARING_PCS];
+	int lines[NumSharingClasses] = { 0 }, invalidations[NumSharingClasses] = { 0 };
+	int falseInvalidations[NumSharingClasses] = { 0 }, transfers[NumSharingClasses] = { 0 };
+	int handoffs[NumSharingClasses] = { 0 };
+	SharingLine** ranked;
+	SharingLine* line;
+	SharingClass c;
+	int i, j;
+
+	for (i = 0; i < tracker->numLines; i++)
+	{
+		line = &tracker->lines[i];
+		c = classifySharingLine(line);
+		lines[c]++;
+		invalidations[c] += line->invalidations;
+		falseInvalidations[c] += line->falseInvalidations;
+		transfers[c] += line->transfers;
+		handoffs[c] += line->handoffs;
+	}
+
+	fprintf(out, "Sharing analysis, %d-word lines, %d lines accessed\n", tracker->lineWords, tracker->numLines);
+	fprintf(out, "%-18s %8s %12s %8s %10s %9s\n", "class", "lines", "invalidates", "false", "transfers", "handoffs");
+	for (c = 0; c < NumSharingClasses; c++)
+		fprintf(out, "%-18s %8d %12d %8d %10d %9d\n", sharingClassNames[c], lines[c], invalidations[c],
+			falseInvalidations[c], transfers[c], handoffs[c]);
+
+	if ((ranked = (SharingLine**)malloc((tracker->numLines + 1) * sizeof(SharingLine*))) == NULL)
+		return;
+	for (i = 0; i < tracker->numLines; i++)
+		ranked[i] = &tracker->lines[i];
+	qsort(ranked, tracker->numLines, sizeof(SharingLine*), compareSharingLines);
+
+	fprintf(out, "\nLines with the most coherence events (word sets in hex, instructions as core:pc x events)\n");
+	fprintf(out, "%8s %-18s %7s %7s %7s %8s  %s\n", "address", "class", "inval", "false", "xfers", "handoffs",
+		"cores read/written, instructions");
+	for (i = 0; i < tracker->numLines && i < maxLines; i++)
+	{
+		line = ranked[i];
+		if (line->invalidations + line->transfers == 0)
+			break;
+		fprintf(out, "%8d %-18s %7d %7d %7d %8d ", line->line << tracker->lineShift,
+			sharingClassNames[classifySharingLine(line)], line->invalidations, line->falseInvalidations,
+			line->transfers, line->handoffs);
+		for (j = 0; j < NUM_CORES; j++)
+			if (line->reads[j] + line->writes[j] > 0)
+				fprintf(out, " c%d:%x/%x", j, line->readWords[j], line->writeWords[j]);
+		fprintf(out, ",");
+		memcpy(pcs, line->pcs, sizeof(pcs));
+		qsort(pcs, MAX_SHARING_PCS, sizeof(SharingPC), compareSharingPCs);
+		for (j = 0; j < MAX_SHARING_PCS; j++)
+			if (pcs[j].events > 0)
+				fprintf(out, " %d:%d x%d", pcs[j].core, pcs[j].pc, pcs[j].events);
+		fprintf(out, "\n");
+	}
+	free(ranked);
+}
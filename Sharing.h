@@ -0,0 +1,83 @@
+#ifndef SHARING_H
+#define SHARING_H
+
+#include "Shared.h"
+
+#define MAX_SHARING_LINE_WORDS 32   /* Word sets of a line are bit masks */
+#define MAX_SHARING_PCS 4           /* Instructions kept per line, the most frequent ones */
+
+/* Sharing pattern analysis
+ *
+ * Every memory access the pipelines complete is recorded against a line of
+ * lineWords words, which may be larger than the simulated cache blocks to ask
+ * what a layout would do with longer lines. Per line the tracker keeps the
+ * words each core read and wrote and runs an MSI model of the line: a write
+ * invalidates the other copies, and the invalidation is false sharing when
+ * the invalidated core has not touched the written word since it got its
+ * copy. A read of a line another core modified is a transfer, a write by a
+ * core that read the line after another core wrote it is a migratory handoff.
+ * The instructions causing invalidations and transfers are counted per line.
+ */
+
+typedef enum
+{
+	SharingPrivate = 0,     /* Accessed by one core */
+	SharingReadOnly,        /* Read by several cores, written by none */
+	SharingMigratory,       /* Read then written by one core after another */
+	SharingProducerConsumer,/* Written by one core, read by others */
+	SharingFalse,           /* Most invalidations hit words the invalidated core did not use */
+	SharingReadWrite,       /* Read and written by several cores otherwise */
+	NumSharingClasses
+} SharingClass;
+
+typedef struct
+{
+	int core;
+	int pc;
+	int events;             /* Invalidations and transfers caused */
+} SharingPC;
+
+typedef struct
+{
+	int line;               /* First word address / lineWords */
+	unsigned int readWords[NUM_CORES];      /* Bit i is word i of the line */
+	unsigned int writeWords[NUM_CORES];
+	unsigned int touchedWords[NUM_CORES];   /* Words accessed since the core's copy was filled */
+	int reads[NUM_CORES];
+	int writes[NUM_CORES];
+	unsigned int holders;   /* Cores holding a copy in the model */
+	int owner;              /* Core holding it modified, -1 if none */
+	int lastWriter;
+	unsigned int readersSinceWrite;
+	int invalidations;
+	int falseInvalidations;
+	int transfers;
+	int handoffs;
+	SharingPC pcs[MAX_SHARING_PCS];
+} SharingLine;
+
+struct SharingTracker_
+{
+	int lineWords;
+	int lineShift;
+	int* lineIndex;         /* Index + 1 into lines of every line of memory, 0 if untouched */
+	SharingLine* lines;
+	int numLines;
+	int capacity;
+};
+typedef struct SharingTracker_* SharingTracker;
+
+// lineWords is a power of two up to MAX_SHARING_LINE_WORDS, NULL on errors
+SharingTracker createSharingTracker(int lineWords);
+void destroySharingTracker(SharingTracker tracker);
+
+// Record an access by core at pc, completed in MEM
+void recordSharingAccess(SharingTracker tracker, int core, int pc, int addr, bool write);
+
+SharingClass classifySharingLine(const SharingLine* line);
+const char* getSharingClassName(SharingClass sharingClass);
+
+// Print the class totals and the lines with the most coherence events
+void printSharingReport(SharingTracker tracker, FILE* out, int maxLines);
+
+#endif
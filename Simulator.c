@@ -0,0 +1,167 @@
+#include <string.h>
+#include "Simulator.h"
+#include "Checkpoint.h"
+
+void simGetDefaultConfig(SimConfig* config)
+{
+	getDefaultConfig(config);
+	config->busTraceFileName = NULL;
+}
+
+SimHandle simCreate(const SimConfig* config, const char* programs[NUM_CORES])
+{
+	SimHandle sim;
+	Program progs[NUM_CORES];
+	int i, j;
+
+	/* Parse the programs */
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		progs[i] = createProgram();
+		if (progs[i] == NULL || !progTextScanner(progs[i], programs[i]))
+		{
+			for (j = 0; j <= i; j++)
+				destroyProgram(progs[j]);
+			return NULL;
+		}
+	}
+
+	sim = simCreateFromPrograms(config, progs);
+	if (sim == NULL)
+	{
+		for (i = 0; i < NUM_CORES; i++)
+			destroyProgram(progs[i]);
+		return NULL;
+	}
+	sim->ownsPrograms = True;
+
+	return sim;
+}
+
+SimHandle simCreateFromPrograms(const SimConfig* config, Program progs[NUM_CORES])
+{
+	SimHandle sim = CreateNewComputer();
+
+	if (sim == NULL)
+		return NULL;
+
+	if (!initializeComputerWithPrograms(sim, progs, config))
+	{
+		destroyComputer(sim);
+		return NULL;
+	}
+	return sim;
+}
+
+void simDestroy(SimHandle sim)
+{
+	if (sim != NULL)
+		destroyComputer(sim);
+}
+
+int simStep(SimHandle sim, int numCycles)
+{
+	int start = sim->totalCycles;
+	int i;
+
+	for (i = 0; i < numCycles; i++)
+		if (runComputerOneCycle(sim))
+			break;
+
+	return sim->totalCycles - start;
+}
+
+void simRun(SimHandle sim)
+{
+	runComputer(sim);
+}
+
+bool simIsHalted(SimHandle sim)
+{
+	int i;
+
+	for (i = 0; i < NUM_CORES; i++)
+		if (!sim->pipes[i]->totally_done || sim->pipes[i]->faulted)
+			return False;
+	return True;
+}
+
+void simGetStats(SimHandle sim, SimStats* stats)
+{
+	int i, j;
+	Pipeline* pipe;
+	Cache cache;
+
+	stats->halted = simIsHalted(sim);
+	stats->faulted = hasComputerFaulted(sim);
+	stats->cycles = readRegisteredCounter(sim->stats, &sim->totalCycles);
+	for (i = 0; i < NumBusCommands; i++)
+		stats->busCmds[i] = readRegisteredCounter(sim->stats, &sim->bus->cmdCount[i]);
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		pipe = sim->pipes[i];
+		cache = sim->caches[i];
+		stats->cores[i].halted = pipe->totally_done && !pipe->faulted;
+		stats->cores[i].faulted = pipe->faulted;
+		stats->cores[i].cycles = readRegisteredCounter(sim->stats, &pipe->totalCycles);
+		stats->cores[i].instructions = readRegisteredCounter(sim->stats, &pipe->wbUtil);
+		stats->cores[i].ifUtil = readRegisteredCounter(sim->stats, &pipe->ifUtil);
+		stats->cores[i].idUtil = readRegisteredCounter(sim->stats, &pipe->idUtil);
+		stats->cores[i].exUtil = readRegisteredCounter(sim->stats, &pipe->exUtil);
+		stats->cores[i].memUtil = readRegisteredCounter(sim->stats, &pipe->memUtil);
+		stats->cores[i].wbUtil = readRegisteredCounter(sim->stats, &pipe->wbUtil);
+		stats->cores[i].dataStallCycles = readRegisteredCounter(sim->stats, &pipe->dataStallCycles);
+		stats->cores[i].loadUseStallCycles = readRegisteredCounter(sim->stats, &pipe->loadUseStallCycles);
+		stats->cores[i].stallCyclesAvoided = readRegisteredCounter(sim->stats, &pipe->stallCyclesAvoided);
+		stats->cores[i].branches = readRegisteredCounter(sim->stats, &pipe->branches);
+		stats->cores[i].mispredictions = readRegisteredCounter(sim->stats, &pipe->mispredictions);
+		stats->cores[i].flushCycles = readRegisteredCounter(sim->stats, &pipe->flushCycles);
+		stats->cores[i].pairedIssues = readRegisteredCounter(sim->stats, &pipe->pairedIssues);
+		stats->cores[i].bufferedStores = readRegisteredCounter(sim->stats, &pipe->bufferedStores);
+		stats->cores[i].storeForwards = readRegisteredCounter(sim->stats, &pipe->storeForwards);
+		stats->cores[i].storeBufferStalls = readRegisteredCounter(sim->stats, &pipe->storeBufferStalls);
+		stats->cores[i].storeCyclesHidden = readRegisteredCounter(sim->stats, &pipe->storeCyclesHidden);
+		stats->cores[i].fastForwarded = readRegisteredCounter(sim->stats, &pipe->fastForwarded);
+		stats->cores[i].cacheHits = readRegisteredCounter(sim->stats, &cache->hits);
+		stats->cores[i].cacheMisses = readRegisteredCounter(sim->stats, &cache->misses);
+		stats->cores[i].cacheReads = readRegisteredCounter(sim->stats, &cache->reads);
+		stats->cores[i].cacheWrites = readRegisteredCounter(sim->stats, &cache->writes);
+		for (j = 0; j < NumCycleBuckets; j++)
+			stats->cores[i].cycleBuckets[j] = readRegisteredCounter(sim->stats, &pipe->cycleBuckets[j]);
+	}
+}
+
+int simGetRegister(SimHandle sim, int coreId, int reg)
+{
+	if (coreId < 0 || coreId >= NUM_CORES || reg < 0 || reg >= NUM_REGS)
+		return 0;
+	return sim->pipes[coreId]->registers[reg];
+}
+
+int simReadMemory(SimHandle sim, int address)
+{
+	int i;
+	Block block;
+
+	if (address < 0 || address >= MEM_SIZE)
+		return 0;
+
+	for (i = 0; i < NUM_CORES; i++)
+	{
+		block = findBlock(sim->caches[i], address);
+		if (block != NULL && block->invalid == 0 && block->modified == 1)
+			return block->data;
+	}
+	return sim->mem->data[address];
+}
+
+int simSaveCheckpoint(SimHandle sim, char* fileName)
+{
+	return saveCheckpointFile(sim, fileName);
+}
+
+int simRestoreCheckpoint(SimHandle sim, char* fileName)
+{
+	return restoreCheckpointFile(sim, fileName);
+}
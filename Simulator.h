@@ -0,0 +1,99 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+/* Library interface for embedding the simulator.
+ *
+ * Every simulation is a handle created from a configuration and programs held
+ * in memory. The library has no global state, so different handles may be
+ * used concurrently from different threads. A single handle must not be used
+ * by two threads at the same time. No file is written unless the
+ * configuration names a bus trace file.
+ */
+
+#include "Shared.h"
+#include "MultiCoreComputer.h"
+
+typedef struct MultiCoreComputer* SimHandle;
+
+/* Statistics of one core */
+typedef struct
+{
+	bool halted;
+	bool faulted;               /* Stopped on an invalid instruction, not halted */
+	int cycles;
+	int instructions;
+	int ifUtil;
+	int idUtil;
+	int exUtil;
+	int memUtil;
+	int wbUtil;
+	int dataStallCycles;
+	int loadUseStallCycles;
+	int stallCyclesAvoided;     /* Data hazard cycles saved by forwarding */
+	int branches;
+	int mispredictions;
+	int flushCycles;
+	int pairedIssues;           /* Cycles two instructions issued, IPC is instructions / cycles and issue slot
+	                               utilization idUtil / (cycles * issue width) */
+	int bufferedStores;         /* Store buffer of TotalStoreOrder computers */
+	int storeForwards;
+	int storeBufferStalls;
+	int storeCyclesHidden;      /* Cycles stores waited in the buffer while the core ran on */
+	int fastForwarded;          /* Instructions executed functionally, not in the counts above */
+	int cacheHits;
+	int cacheMisses;
+	int cacheReads;
+	int cacheWrites;
+	int cycleBuckets[NumCycleBuckets]; /* CPI stack, adding up to the computer's cycles */
+} SimCoreStats;
+
+/* Statistics of the whole computer */
+typedef struct
+{
+	bool halted;
+	bool faulted;               /* A core stopped on an invalid instruction, the run failed */
+	int cycles;
+	int busCmds[NumBusCommands];
+	SimCoreStats cores[NUM_CORES];
+} SimStats;
+
+/* Default configuration, without a bus trace */
+void simGetDefaultConfig(SimConfig* config);
+
+/* Create a simulation from the assembly source of each core.
+   Returns NULL if a program does not parse or the configuration is invalid. */
+SimHandle simCreate(const SimConfig* config, const char* programs[NUM_CORES]);
+
+/* Create a simulation sharing already parsed programs, which must outlive it */
+SimHandle simCreateFromPrograms(const SimConfig* config, Program progs[NUM_CORES]);
+
+void simDestroy(SimHandle sim);
+
+/* Run up to numCycles cycles, stopping early when all cores halt.
+   Returns the number of cycles run. */
+int simStep(SimHandle sim, int numCycles);
+
+/* Run until all cores halt or the configured cycle limit is reached */
+void simRun(SimHandle sim);
+
+bool simIsHalted(SimHandle sim);
+/* Statistics since the last reset, up to roi_end when a region of interest
+   closed. fastForwarded always covers the whole run. */
+void simGetStats(SimHandle sim, SimStats* stats);
+
+/* Register of a core, 0 for an invalid core or register */
+int simGetRegister(SimHandle sim, int coreId, int reg);
+
+/* Write the whole state of the simulation to a checkpoint file (see
+   Checkpoint.h), returns 1 on success */
+int simSaveCheckpoint(SimHandle sim, char* fileName);
+
+/* Continue from a checkpoint taken running the same programs. The simulation
+   may have another cache geometry, memory latency, forwarding or branch
+   predictor. Returns 1 on success. */
+int simRestoreCheckpoint(SimHandle sim, char* fileName);
+
+/* Coherent value of a memory word: a modified cached copy takes precedence */
+int simReadMemory(SimHandle sim, int address);
+
+#endif
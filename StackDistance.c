@@ -0,0 +1,289 @@
+#include <string.h>
+#include "StackDistance.h"
+#include "Memory.h"
+
+StackDistance createStackDistance(int associativity)
+{
+	StackDistance sd;
+	ReuseStream* stream;
+	int i, k;
+
+	if (associativity < 0 || associativity > MAX_STACK_ASSOCIATIVITY)
+	{
+		fprintf(stderr, "Stack distance associativity must be between 0 and %d.\n", MAX_STACK_ASSOCIATIVITY);
+		return NULL;
+	}
+	if ((sd = (StackDistance)calloc(1, sizeof(struct StackDistance_))) == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for the stack distance analysis.\n");
+		return NULL;
+	}
+	sd->associativity = associativity;
+
+	for (i = 0; i <= NUM_CORES; i++)
+	{
+		stream = &sd->streams[i];
+		stream->capacity = INITIAL_REUSE_TIMES;
+		stream->lastTime = (int*)calloc(MEM_SIZE, sizeof(int));
+		stream->tree = (int*)calloc(stream->capacity + 1, sizeof(int));
+		stream->blockAt = (int*)malloc(stream->capacity * sizeof(int));
+		if (stream->lastTime == NULL || stream->tree == NULL || stream->blockAt == NULL)
+		{
+			fprintf(stderr, "Could not allocate memory for the stack distance analysis.\n");
+			destroyStackDistance(sd);
+			return NULL;
+		}
+		for (k = 0; associativity > 0 && k <= MAX_STACK_SETS_LOG; k++)
+			if ((stream->setStacks[k] = (int*)calloc((1 << k) * associativity, sizeof(int))) == NULL)
+			{
+				fprintf(stderr, "Could not allocate memory for the stack distance analysis.\n");
+				destroyStackDistance(sd);
+				return NULL;
+			}
+	}
+	return sd;
+}
+
+void destroyStackDistance(StackDistance sd)
+{
+	int i, k;
+
+	if (sd == NULL)
+		return;
+
+	for (i = 0; i <= NUM_CORES; i++)
+	{
+		free(sd->streams[i].lastTime);
+		free(sd->streams[i].tree);
+		free(sd->streams[i].blockAt);
+		free(sd->streams[i].distances);
+		for (k = 0; k <= MAX_STACK_SETS_LOG; k++)
+			free(sd->streams[i].setStacks[k]);
+	}
+	free(sd);
+}
+
+// Add delta at a 1-based position of the tree
+void addReuseTree(ReuseStream* stream, int position, int delta)
+{
+	for (; position <= stream->capacity; position += position & -position)
+		stream->tree[position] += delta;
+}
+
+// Sum of the tree up to and including a 1-based position
+int sumReuseTree(const ReuseStream* stream, int position)
+{
+	int sum = 0;
+
+	for (; position > 0; position -= position & -position)
+		sum += stream->tree[position];
+	return sum;
+}
+
+// Renumber the last references in order from time 0, doubling the tree when
+// they would fill more than half of it. Returns False when out of memory.
+bool compactReuseStream(ReuseStream* stream)
+{
+	int* tree;
+	int* blockAt;
+	int t, block, position, parent, live = 0;
+
+	if (stream->live * 2 > stream->capacity)
+	{
+		if ((blockAt = (int*)realloc(stream->blockAt, stream->capacity * 2 * sizeof(int))) == NULL)
+			return False;
+		stream->blockAt = blockAt;
+		if ((tree = (int*)realloc(stream->tree, (stream->capacity * 2 + 1) * sizeof(int))) == NULL)
+			return False;
+		stream->tree = tree;
+		stream->capacity *= 2;
+	}
+
+	for (t = 0; t < stream->time; t++)
+	{
+		block = stream->blockAt[t];
+		if (stream->lastTime[block] == t + 1)
+		{
+			stream->blockAt[live] = block;
+			stream->lastTime[block] = ++live;
+		}
+	}
+	stream->time = live;
+
+	// Linear build: the first live positions hold a 1, every node passes its sum to its parent
+	memset(stream->tree, 0, (stream->capacity + 1) * sizeof(int));
+	for (position = 1; position <= stream->capacity; position++)
+	{
+		if (position <= live)
+			stream->tree[position]++;
+		parent = position + (position & -position);
+		if (parent <= stream->capacity)
+			stream->tree[parent] += stream->tree[position];
+	}
+	return True;
+}
+
+// Count a reference at a stack distance, growing the histogram as needed
+void countStackDistance(ReuseStream* stream, int distance)
+{
+	int* distances;
+	int size;
+
+	if (distance >= stream->numDistances)
+	{
+		size = (stream->numDistances > 0) ? stream->numDistances : 64;
+		while (size <= distance)
+			size *= 2;
+		if ((distances = (int*)realloc(stream->distances, size * sizeof(int))) == NULL)
+			return;
+		memset(distances + stream->numDistances, 0, (size - stream->numDistances) * sizeof(int));
+		stream->distances = distances;
+		stream->numDistances = size;
+	}
+	stream->distances[distance]++;
+}
+
+// Move a block to the top of its set in every set stack, counting the depth it was found at
+void recordSetReference(ReuseStream* stream, int associativity, int block)
+{
+	int* set;
+	int k, way;
+
+	for (k = 0; k <= MAX_STACK_SETS_LOG; k++)
+	{
+		set = stream->setStacks[k] + (block & ((1 << k) - 1)) * associativity;
+		for (way = 0; way < associativity - 1 && set[way] != block + 1; way++)
+			;
+		if (set[way] == block + 1)
+			stream->setHits[k][way]++;
+		memmove(set + 1, set, way * sizeof(int));
+		set[0] = block + 1;
+	}
+}
+
+void recordStreamReference(ReuseStream* stream, int associativity, int block)
+{
+	int previous;
+
+	if (stream->time == stream->capacity && !compactReuseStream(stream))
+	{
+		fprintf(stderr, "Could not allocate memory for the stack distance analysis.\n");
+		return;
+	}
+	previous = stream->lastTime[block];
+
+	stream->references++;
+	if (previous == 0)
+	{
+		stream->coldMisses++;
+		stream->live++;
+	}
+	else
+	{
+		// Blocks whose last reference came after this block's
+		countStackDistance(stream, stream->live - sumReuseTree(stream, previous));
+		addReuseTree(stream, previous, -1);
+	}
+	stream->blockAt[stream->time] = block;
+	stream->lastTime[block] = ++stream->time;
+	addReuseTree(stream, stream->time, 1);
+
+	if (associativity > 0)
+		recordSetReference(stream, associativity, block);
+}
+
+void recordReference(StackDistance sd, int core, int block)
+{
+	if (block < 0 || block >= MEM_SIZE)
+		return;
+	recordStreamReference(&sd->streams[core], sd->associativity, block);
+	recordStreamReference(&sd->streams[NUM_CORES], sd->associativity, block);
+}
+
+long long getStackMisses(const ReuseStream* stream, int size)
+{
+	long long hits = 0;
+	int d;
+
+	for (d = 0; d < size && d < stream->numDistances; d++)
+		hits += stream->distances[d];
+	return stream->references - hits;
+}
+
+double getStackMissRatio(long long misses, long long references)
+{
+	return (references > 0) ? (double)misses / references : 0.0;
+}
+
+// Columns of the set-associative curves: powers of two, then the associativity itself
+int getNextWays(int ways, int associativity)
+{
+	return (ways < associativity && ways * 2 > associativity) ? associativity : ways * 2;
+}
+
+void printStackDistanceReport(StackDistance sd, FILE* out)
+{
+	ReuseStream* stream;
+	long long hits;
+	bool reachedCold;
+	int i, k, size, ways;
+
+	fprintf(out, "Fully associative LRU miss ratio by size in blocks\n");
+	fprintf(out, "%10s", "");
+	for (i = 0; i < NUM_CORES; i++)
+		fprintf(out, "    core%d", i);
+	fprintf(out, " %8s\n", "all");
+	fprintf(out, "%-10s", "references");
+	for (i = 0; i <= NUM_CORES; i++)
+		fprintf(out, " %8lld", sd->streams[i].references);
+	fprintf(out, "\n%-10s", "blocks");
+	for (i = 0; i <= NUM_CORES; i++)
+		fprintf(out, " %8d", sd->streams[i].live);
+	fprintf(out, "\n");
+
+	// Sizes up to the first at which only the cold misses are left in every stream
+	for (size = 1; size <= MEM_SIZE; size *= 2)
+	{
+		reachedCold = True;
+		fprintf(out, "%10d", size);
+		for (i = 0; i <= NUM_CORES; i++)
+		{
+			stream = &sd->streams[i];
+			fprintf(out, " %8.4f", getStackMissRatio(getStackMisses(stream, size), stream->references));
+			if (getStackMisses(stream, size) > stream->coldMisses)
+				reachedCold = False;
+		}
+		fprintf(out, "\n");
+		if (reachedCold)
+			break;
+	}
+
+	if (sd->associativity == 0)
+		return;
+	for (i = 0; i <= NUM_CORES; i++)
+	{
+		stream = &sd->streams[i];
+		if (stream->references == 0)
+			continue;
+		if (i < NUM_CORES)
+			fprintf(out, "core%d", i);
+		else
+			fprintf(out, "all");
+		fprintf(out, " set-associative LRU miss ratio by sets and ways\n%10s", "sets");
+		for (ways = 1; ways <= sd->associativity; ways = getNextWays(ways, sd->associativity))
+			fprintf(out, " %8d", ways);
+		fprintf(out, "\n");
+		for (k = 0; k <= MAX_STACK_SETS_LOG; k++)
+		{
+			fprintf(out, "%10d", 1 << k);
+			hits = 0;
+			for (ways = 1, size = 0; ways <= sd->associativity; ways = getNextWays(ways, sd->associativity))
+			{
+				for (; size < ways; size++)
+					hits += stream->setHits[k][size];
+				fprintf(out, " %8.4f", getStackMissRatio(stream->references - hits, stream->references));
+			}
+			fprintf(out, "\n");
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef STACK_DISTANCE_H
+#define STACK_DISTANCE_H
+
+#include "Shared.h"
+
+#define INITIAL_REUSE_TIMES 65536   /* References the tree of a stream holds before it is compacted */
+#define MAX_STACK_SETS_LOG 12       /* Set-associative curves go up to 4096 sets */
+#define MAX_STACK_ASSOCIATIVITY 32
+
+/* Stack distance analysis
+ *
+ * Every reference the pipelines complete is fed to the stream of its core
+ * and to the merged stream of all cores. The LRU stack distance of a
+ * reference is the number of distinct blocks referenced since the last
+ * reference to its block, so it hits in every fully associative LRU cache
+ * larger than that: one run gives the miss ratio of all cache sizes.
+ *
+ * A stream keeps the time of the last reference of each block and a
+ * Fenwick tree over times with a 1 at each of those, so the distance is
+ * the number of ones after the previous reference, found in O(log n). When
+ * the tree is full the live times are renumbered in order.
+ *
+ * With an associativity A, each stream also keeps the LRU stack of every
+ * set of caches with 1, 2, 4 ... 4096 sets, A blocks deep, and counts the
+ * hits at each depth: the miss ratio of every set count at every
+ * associativity up to A.
+ */
+
+typedef struct
+{
+	int* lastTime;          /* Time + 1 of the last reference of each block, 0 if never referenced */
+	int* tree;              /* Fenwick tree over times, 1-based */
+	int* blockAt;           /* Block referenced at each time */
+	int capacity;
+	int time;               /* Next time */
+	int live;               /* Distinct blocks referenced */
+	int* distances;         /* References at each stack distance */
+	int numDistances;
+	long long references;
+	int coldMisses;
+	int* setStacks[MAX_STACK_SETS_LOG + 1];     /* Block + 1 of each way of each set, MRU first */
+	int setHits[MAX_STACK_SETS_LOG + 1][MAX_STACK_ASSOCIATIVITY];
+} ReuseStream;
+
+struct StackDistance_
+{
+	ReuseStream streams[NUM_CORES + 1];         /* The cores, then the merged stream */
+	int associativity;      /* Depth of the set stacks, 0 for none */
+};
+typedef struct StackDistance_* StackDistance;
+
+// associativity 0 gives only the fully associative curves, NULL on errors
+StackDistance createStackDistance(int associativity);
+void destroyStackDistance(StackDistance sd);
+
+// Record a reference of core to a block
+void recordReference(StackDistance sd, int core, int block);
+
+// References of a stream that miss in a fully associative LRU cache of size blocks
+long long getStackMisses(const ReuseStream* stream, int size);
+
+// Print the miss ratio curves of every stream
+void printStackDistanceReport(StackDistance sd, FILE* out);
+
+#endif
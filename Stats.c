@@ -0,0 +1,264 @@
+#include <string.h>
+#include "Stats.h"
+
+#define INITIAL_COUNTERS 64
+
+StatsRegistry createStatsRegistry()
+{
+	StatsRegistry reg = (StatsRegistry)malloc(sizeof(struct StatsRegistry_));
+
+	if (reg == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for statistics.\n");
+		return NULL;
+	}
+
+	reg->counters = NULL;
+	reg->numCounters = 0;
+	reg->capacity = 0;
+	reg->out = NULL;
+	reg->format = StatsCSV;
+	reg->interval = 0;
+	reg->lastSnapshot = -1;
+	return reg;
+}
+
+void destroyStatsRegistry(StatsRegistry reg)
+{
+	int i;
+
+	if (reg == NULL)
+		return;
+
+	for (i = 0; i < reg->numCounters; i++)
+	{
+		free(reg->counters[i].histogramBaseline);
+		free(reg->counters[i].histogramFrozen);
+	}
+	if (reg->out != NULL)
+		fclose(reg->out);
+	free(reg->counters);
+	free(reg);
+}
+
+int registerCounter(StatsRegistry reg, const char* prefix, const char* name, const int* value)
+{
+	StatCounter* counters;
+	int capacity;
+
+	if (reg->numCounters == reg->capacity)
+	{
+		capacity = reg->capacity ? 2 * reg->capacity : INITIAL_COUNTERS;
+		if ((counters = (StatCounter*)realloc(reg->counters, capacity * sizeof(StatCounter))) == NULL)
+		{
+			fprintf(stderr, "Could not allocate memory for statistics.\n");
+			return 0;
+		}
+		reg->counters = counters;
+		reg->capacity = capacity;
+	}
+
+	snprintf(reg->counters[reg->numCounters].name, MAX_STAT_NAME, "%s.%s", prefix, name);
+	reg->counters[reg->numCounters].value = value;
+	reg->counters[reg->numCounters].histogram = NULL;
+	reg->counters[reg->numCounters].percent = 0;
+	reg->counters[reg->numCounters].baseline = 0;
+	reg->counters[reg->numCounters].histogramBaseline = NULL;
+	reg->counters[reg->numCounters].histogramFrozen = NULL;
+	reg->counters[reg->numCounters].frozen = False;
+	reg->numCounters++;
+	return 1;
+}
+
+int registerHistogram(StatsRegistry reg, const char* prefix, const char* name, const LatencyHistogram* histogram)
+{
+	static const int percents[] = { 50, 90, 99, 100 };
+	static const char* suffixes[] = { "p50", "p90", "p99", "max" };
+	char fullName[MAX_STAT_NAME];
+	int i;
+
+	snprintf(fullName, MAX_STAT_NAME, "%s.%s", prefix, name);
+	for (i = 0; i < 4; i++)
+	{
+		if (!registerCounter(reg, fullName, suffixes[i], NULL))
+			return 0;
+		reg->counters[reg->numCounters - 1].histogram = histogram;
+		reg->counters[reg->numCounters - 1].percent = percents[i];
+	}
+	return 1;
+}
+
+// Values the histogram of a counter recorded since the last reset, or up to the freeze
+void readCounterHistogram(const StatCounter* counter, LatencyHistogram* region)
+{
+	if (counter->frozen && counter->histogramFrozen != NULL)
+	{
+		*region = *counter->histogramFrozen;
+		return;
+	}
+	*region = *counter->histogram;
+	if (counter->histogramBaseline != NULL)
+		subtractHistogram(region, counter->histogramBaseline);
+}
+
+int readStatCounter(const StatCounter* counter)
+{
+	LatencyHistogram since;
+
+	if (counter->frozen)
+		return counter->frozenValue;
+	if (counter->histogram == NULL)
+		return *counter->value - counter->baseline;
+
+	readCounterHistogram(counter, &since);
+	return getHistogramPercentile(&since, counter->percent);
+}
+
+int resetStats(StatsRegistry reg)
+{
+	StatCounter* counter;
+	int i;
+
+	for (i = 0; i < reg->numCounters; i++)
+	{
+		counter = &reg->counters[i];
+		counter->frozen = False;
+		if (counter->histogram == NULL)
+			counter->baseline = *counter->value;
+		else
+		{
+			if (counter->histogramBaseline == NULL &&
+				(counter->histogramBaseline = (LatencyHistogram*)malloc(sizeof(LatencyHistogram))) == NULL)
+			{
+				fprintf(stderr, "Could not allocate memory for statistics.\n");
+				return 0;
+			}
+			*counter->histogramBaseline = *counter->histogram;
+		}
+	}
+	return 1;
+}
+
+int freezeStats(StatsRegistry reg)
+{
+	StatCounter* counter;
+	int i, status = 1;
+
+	for (i = 0; i < reg->numCounters; i++)
+	{
+		counter = &reg->counters[i];
+		counter->frozenValue = readStatCounter(counter);
+		if (counter->histogram != NULL && !counter->frozen)
+		{
+			if (counter->histogramFrozen == NULL &&
+				(counter->histogramFrozen = (LatencyHistogram*)malloc(sizeof(LatencyHistogram))) == NULL)
+			{
+				fprintf(stderr, "Could not allocate memory for statistics.\n");
+				status = 0;
+			}
+			else
+				readCounterHistogram(counter, counter->histogramFrozen);
+		}
+		counter->frozen = True;
+	}
+	return status;
+}
+
+int openStatsOutput(StatsRegistry reg, char* fileName, StatsFormat format, int interval)
+{
+	int i;
+
+	if ((reg->out = fopen(fileName, "w")) == NULL)
+	{
+		fprintf(stderr, "Could not open statistics file %s.\n", fileName);
+		return 0;
+	}
+	reg->format = format;
+	reg->interval = interval;
+
+	if (format == StatsCSV)
+	{
+		fprintf(reg->out, "cycle");
+		for (i = 0; i < reg->numCounters; i++)
+			fprintf(reg->out, ",%s", reg->counters[i].name);
+		fprintf(reg->out, "\n");
+	}
+	return 1;
+}
+
+void sampleStats(StatsRegistry reg, int cycle)
+{
+	if (reg->out != NULL && reg->interval > 0 && cycle % reg->interval == 0)
+		writeStatsSnapshot(reg, cycle);
+}
+
+void writeStatsSnapshot(StatsRegistry reg, int cycle)
+{
+	if (cycle != reg->lastSnapshot)
+		dumpStatsSnapshot(reg, cycle);
+}
+
+void dumpStatsSnapshot(StatsRegistry reg, int cycle)
+{
+	int i;
+
+	if (reg->out == NULL)
+		return;
+	reg->lastSnapshot = cycle;
+
+	if (reg->format == StatsCSV)
+	{
+		fprintf(reg->out, "%d", cycle);
+		for (i = 0; i < reg->numCounters; i++)
+			fprintf(reg->out, ",%d", readStatCounter(&reg->counters[i]));
+	}
+	else
+	{
+		fprintf(reg->out, "{\"cycle\":%d", cycle);
+		for (i = 0; i < reg->numCounters; i++)
+			fprintf(reg->out, ",\"%s\":%d", reg->counters[i].name, readStatCounter(&reg->counters[i]));
+		fprintf(reg->out, "}");
+	}
+	fprintf(reg->out, "\n");
+}
+
+void printStatsRegistry(StatsRegistry reg, FILE* out)
+{
+	int i;
+
+	for (i = 0; i < reg->numCounters; i++)
+		fprintf(out, "%-32s %d\n", reg->counters[i].name, readStatCounter(&reg->counters[i]));
+}
+
+int getStatValue(StatsRegistry reg, const char* name)
+{
+	int i;
+
+	for (i = 0; i < reg->numCounters; i++)
+		if (strcmp(reg->counters[i].name, name) == 0)
+			return readStatCounter(&reg->counters[i]);
+	return 0;
+}
+
+int readRegisteredCounter(StatsRegistry reg, const int* value)
+{
+	int i;
+
+	for (i = 0; i < reg->numCounters; i++)
+		if (reg->counters[i].value == value)
+			return readStatCounter(&reg->counters[i]);
+	return *value;
+}
+
+void readRegisteredHistogram(StatsRegistry reg, const LatencyHistogram* histogram, LatencyHistogram* region)
+{
+	int i;
+
+	for (i = 0; i < reg->numCounters; i++)
+		if (reg->counters[i].histogram == histogram)
+		{
+			readCounterHistogram(&reg->counters[i], region);
+			return;
+		}
+	*region = *histogram;
+}
@@ -0,0 +1,83 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "Shared.h"
+#include "Histogram.h"
+
+#define MAX_STAT_NAME 48
+
+/* Registry of named statistics counters
+ *
+ * The modules register the counters they keep with registerPipelineStats,
+ * registerCacheStats, registerBusStats and registerMemoryStats. The registry
+ * only holds pointers, so a snapshot reads the live values. A registered
+ * histogram adds its p50, p90, p99 and max, computed at each snapshot. Snapshots go to
+ * a CSV file, one column per counter, or to JSON lines, one object per
+ * snapshot; both start with the cycle of the snapshot.
+ *
+ * The modules keep counting from the start of the run, as some counters
+ * also time the model. resetStats makes every counter read from 0 again by
+ * remembering its value, and freezeStats keeps reading the values of that
+ * moment until the next reset, so the counters can cover a region of the run.
+ * Reports that read the modules' fields go through readRegisteredCounter and
+ * readRegisteredHistogram to cover the same region.
+ */
+
+typedef enum { StatsCSV = 0, StatsJSONLines, NumStatsFormats } StatsFormat;
+
+typedef struct
+{
+	char name[MAX_STAT_NAME];   /* Like "core0.ifUtil" */
+	const int* value;           /* NULL for a percentile of histogram */
+	const LatencyHistogram* histogram;
+	int percent;
+	int baseline;               /* Value at the last reset */
+	LatencyHistogram* histogramBaseline; /* Histogram at the last reset, NULL before the first */
+	bool frozen;
+	int frozenValue;
+	LatencyHistogram* histogramFrozen;   /* Histogram since the reset at the freeze, NULL before the first */
+} StatCounter;
+
+struct StatsRegistry_
+{
+	StatCounter* counters;
+	int numCounters;
+	int capacity;
+	FILE* out;              /* NULL until an output is opened */
+	StatsFormat format;
+	int interval;           /* Cycles between snapshots */
+	int lastSnapshot;       /* Cycle of the last snapshot, -1 before the first */
+};
+typedef struct StatsRegistry_* StatsRegistry;
+
+StatsRegistry createStatsRegistry();
+// Closes the output
+void destroyStatsRegistry(StatsRegistry reg);
+// Register a counter under prefix.name, returns 0 when out of memory
+int registerCounter(StatsRegistry reg, const char* prefix, const char* name, const int* value);
+// Register the percentiles of a histogram as prefix.name.p50 ... prefix.name.max
+int registerHistogram(StatsRegistry reg, const char* prefix, const char* name, const LatencyHistogram* histogram);
+// Current value of a counter since the last reset, or its frozen value
+int readStatCounter(const StatCounter* counter);
+// Count every counter from 0 again and unfreeze it, returns 0 when out of memory
+int resetStats(StatsRegistry reg);
+// Keep every counter at its current value until the next reset, returns 0 when out of memory
+int freezeStats(StatsRegistry reg);
+// Write a snapshot every interval cycles to fileName, returns 0 when it cannot be opened
+int openStatsOutput(StatsRegistry reg, char* fileName, StatsFormat format, int interval);
+// Write a snapshot if cycle is a multiple of the interval
+void sampleStats(StatsRegistry reg, int cycle);
+// Write a snapshot unless one was written at this cycle
+void writeStatsSnapshot(StatsRegistry reg, int cycle);
+// Write a snapshot even if one was written at this cycle, for explicit stats_dump instructions
+void dumpStatsSnapshot(StatsRegistry reg, int cycle);
+// Print every counter and its value, one per line
+void printStatsRegistry(StatsRegistry reg, FILE* out);
+// Value of a registered counter, 0 if there is none of that name
+int getStatValue(StatsRegistry reg, const char* name);
+// Value of the counter registered at value as the registry reads it, *value if none is
+int readRegisteredCounter(StatsRegistry reg, const int* value);
+// Values of a registered histogram since the last reset, or up to the freeze, the whole histogram if it is not registered
+void readRegisteredHistogram(StatsRegistry reg, const LatencyHistogram* histogram, LatencyHistogram* region);
+
+#endif
@@ -0,0 +1,78 @@
+#include "StoreBuffer.h"
+
+StoreBuffer createStoreBuffer()
+{
+	StoreBuffer sb = (StoreBuffer)malloc(sizeof(struct StoreBuffer_));
+
+	if (sb == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for store buffer.\n");
+		return NULL;
+	}
+
+	sb->head = 0;
+	sb->count = 0;
+	return sb;
+}
+
+void destroyStoreBuffer(StoreBuffer sb)
+{
+	free(sb);
+}
+
+bool isStoreBufferFull(StoreBuffer sb)
+{
+	return sb->count == STORE_BUFFER_ENTRIES;
+}
+
+bool isStoreBufferEmpty(StoreBuffer sb)
+{
+	return sb->count == 0;
+}
+
+void pushStore(StoreBuffer sb, int addr, int data, int cycle)
+{
+	StoreBufferEntry* entry = &sb->entries[(sb->head + sb->count) % STORE_BUFFER_ENTRIES];
+
+	entry->addr = addr;
+	entry->data = data;
+	entry->cycle = cycle;
+	sb->count++;
+}
+
+StoreBufferEntry* getOldestStore(StoreBuffer sb)
+{
+	return (sb->count > 0) ? &sb->entries[sb->head] : NULL;
+}
+
+void popStore(StoreBuffer sb)
+{
+	sb->head = (sb->head + 1) % STORE_BUFFER_ENTRIES;
+	sb->count--;
+}
+
+bool forwardStore(StoreBuffer sb, int addr, int* data)
+{
+	int i;
+	StoreBufferEntry* entry;
+
+	for (i = sb->count - 1; i >= 0; i--)
+	{
+		entry = &sb->entries[(sb->head + i) % STORE_BUFFER_ENTRIES];
+		if (entry->addr == addr)
+		{
+			*data = entry->data;
+			return True;
+		}
+	}
+	return False;
+}
+
+const char* getMemoryModelName(MemoryModel model)
+{
+	static const char* names[NumMemoryModels] = { "sc", "tso" };
+
+	if (model < 0 || model >= NumMemoryModels)
+		return "unknown";
+	return names[model];
+}
@@ -0,0 +1,46 @@
+#ifndef STORE_BUFFER_H
+#define STORE_BUFFER_H
+
+#include "Shared.h"
+
+#define STORE_BUFFER_ENTRIES 8
+
+/* Ordering of a core's memory operations as seen by the other cores */
+typedef enum
+{
+	SequentialConsistency = 0,  /* A store holds MEM until the cache owns its block */
+	TotalStoreOrder,            /* Stores retire into a FIFO store buffer, loads may pass them */
+	NumMemoryModels
+} MemoryModel;
+
+typedef struct
+{
+	int addr;
+	int data;
+	int cycle;              /* Pipeline cycle the store retired into the buffer */
+} StoreBufferEntry;
+
+/* FIFO of retired stores waiting for ownership of their block. The oldest
+   store is written to the cache first, so other cores see the stores of a
+   core in program order. */
+struct StoreBuffer_
+{
+	StoreBufferEntry entries[STORE_BUFFER_ENTRIES];
+	int head;               /* Oldest store */
+	int count;
+};
+typedef struct StoreBuffer_* StoreBuffer;
+
+StoreBuffer createStoreBuffer();
+void destroyStoreBuffer(StoreBuffer sb);
+bool isStoreBufferFull(StoreBuffer sb);
+bool isStoreBufferEmpty(StoreBuffer sb);
+void pushStore(StoreBuffer sb, int addr, int data, int cycle);
+// Oldest store, NULL when the buffer is empty
+StoreBufferEntry* getOldestStore(StoreBuffer sb);
+void popStore(StoreBuffer sb);
+// Data of the youngest buffered store to addr, returns False if there is none
+bool forwardStore(StoreBuffer sb, int addr, int* data);
+const char* getMemoryModelName(MemoryModel model);
+
+#endif
@@ -0,0 +1,463 @@
+#include <string.h>
+#include "Suite.h"
+#include "Simulator.h"
+#include "Bench.h"
+
+#define MAX_SUITE_LINE 4096
+#define MAX_SUITE_PATH 512
+
+int readSuite(char* dir, SuiteWorkload workloads[], int* numWorkloads)
+{
+	char line[MAX_SUITE_LINE];
+	char fileName[MAX_SUITE_PATH];
+	SuiteWorkload* w;
+	FILE* suiteFile;
+
+	snprintf(fileName, MAX_SUITE_PATH, "%.400s/suite.txt", dir);
+	if ((suiteFile = fopen(fileName, "r")) == NULL)
+	{
+		fprintf(stderr, "Could not open suite %s.\n", fileName);
+		return 0;
+	}
+
+	*numWorkloads = 0;
+	while (fgets(line, MAX_SUITE_LINE, suiteFile))
+	{
+		if (strchr(line, '#') != NULL)
+			*strchr(line, '#') = '\0';
+		w = &workloads[*numWorkloads];
+		if (sscanf(line, "%63s", w->name) != 1)
+			continue;
+
+		if (sscanf(line, "%*s %d %d", &w->memStart, &w->memWords) != 2 ||
+			w->memStart < 0 || w->memWords < 0 || w->memWords > MAX_GOLDEN_WORDS ||
+			w->memStart + w->memWords > MEM_SIZE)
+		{
+			fprintf(stderr, "Workload %s needs a memory range of at most %d words.\n", w->name, MAX_GOLDEN_WORDS);
+			fclose(suiteFile);
+			return 0;
+		}
+		if (++*numWorkloads == MAX_SUITE_WORKLOADS)
+			break;
+	}
+
+	fclose(suiteFile);
+	return 1;
+}
+
+// Read count integers following the key of a golden line
+int readGoldenValues(char* line, int values[], int count)
+{
+	char* p = line;
+	int i, length;
+
+	sscanf(p, "%*s%n", &length);
+	p += length;
+	for (i = 0; i < count; i++)
+	{
+		if (sscanf(p, "%d%n", &values[i], &length) != 1)
+			return 0;
+		p += length;
+	}
+	return 1;
+}
+
+int readGolden(char* fileName, const SuiteWorkload* workload, SuiteResult* golden)
+{
+	char line[MAX_SUITE_LINE];
+	char key[MAX_SUITE_LINE];
+	int values[NUM_REGS + 1];
+	bool haveCycles = False, haveMemory = False;
+	int numRegs = 0;
+	FILE* goldenFile = fopen(fileName, "r");
+
+	if (goldenFile == NULL)
+	{
+		fprintf(stderr, "Could not open golden results %s.\n", fileName);
+		return 0;
+	}
+
+	memset(golden, 0, sizeof(SuiteResult));
+	while (fgets(line, MAX_SUITE_LINE, goldenFile))
+	{
+		if (strchr(line, '#') != NULL)
+			*strchr(line, '#') = '\0';
+		if (sscanf(line, "%s", key) != 1)
+			continue;
+
+		if (strcmp(key, "cycles") == 0 && readGoldenValues(line, values, 1))
+		{
+			golden->cycles = values[0];
+			haveCycles = True;
+		}
+		else if (strcmp(key, "regs") == 0 && readGoldenValues(line, values, NUM_REGS + 1) &&
+			values[0] >= 0 && values[0] < NUM_CORES)
+		{
+			memcpy(golden->registers[values[0]], &values[1], NUM_REGS * sizeof(int));
+			numRegs++;
+		}
+		else if (strcmp(key, "mem") == 0 && readGoldenValues(line, values, 1) && values[0] == workload->memStart)
+		{
+			int* memory = (int*)malloc((workload->memWords + 1) * sizeof(int));
+
+			haveMemory = (memory != NULL && readGoldenValues(line, memory, workload->memWords + 1));
+			if (haveMemory)
+				memcpy(golden->memory, &memory[1], workload->memWords * sizeof(int));
+			free(memory);
+		}
+		else
+		{
+			fprintf(stderr, "%s: bad line %s", fileName, line);
+			fclose(goldenFile);
+			return 0;
+		}
+	}
+
+	fclose(goldenFile);
+	if (!haveCycles || numRegs != NUM_CORES || !haveMemory)
+	{
+		fprintf(stderr, "%s lacks the cycles, registers of every core or memory from %d.\n", fileName, workload->memStart);
+		return 0;
+	}
+	return 1;
+}
+
+int writeGolden(char* fileName, const SuiteWorkload* workload, const SuiteResult* result)
+{
+	int core, i;
+	FILE* goldenFile = fopen(fileName, "w");
+
+	if (goldenFile == NULL)
+	{
+		fprintf(stderr, "Could not write golden results %s.\n", fileName);
+		return 0;
+	}
+
+	fprintf(goldenFile, "# Golden results of %s with the default configuration\n", workload->name);
+	fprintf(goldenFile, "cycles %d\n", result->cycles);
+	for (core = 0; core < NUM_CORES; core++)
+	{
+		fprintf(goldenFile, "regs %d", core);
+		for (i = 0; i < NUM_REGS; i++)
+			fprintf(goldenFile, " %d", result->registers[core][i]);
+		fprintf(goldenFile, "\n");
+	}
+	fprintf(goldenFile, "mem %d", workload->memStart);
+	for (i = 0; i < workload->memWords; i++)
+		fprintf(goldenFile, " %d", result->memory[i]);
+	fprintf(goldenFile, "\n");
+
+	fclose(goldenFile);
+	return 1;
+}
+
+int runWorkload(const SuiteWorkload* workload, Program progs[], SuiteResult* result, double* nsPerCycle)
+{
+	SimConfig config;
+	SimHandle sim;
+	double start, seconds, total = 0;
+	int core, i, runs = 0;
+
+	simGetDefaultConfig(&config);
+	config.maxCycles = SUITE_MAX_CYCLES;
+
+	do
+	{
+		if ((sim = simCreateFromPrograms(&config, progs)) == NULL)
+			return 0;
+		start = benchTime();
+		simRun(sim);
+		seconds = benchTime() - start;
+		total += seconds;
+		if (!simIsHalted(sim))
+		{
+			fprintf(stderr, "Workload %s did not halt in %d cycles.\n", workload->name, SUITE_MAX_CYCLES);
+			simDestroy(sim);
+			return 0;
+		}
+
+		if (runs++ == 0)
+		{
+			result->cycles = sim->totalCycles;
+			for (core = 0; core < NUM_CORES; core++)
+				for (i = 0; i < NUM_REGS; i++)
+					result->registers[core][i] = simGetRegister(sim, core, i);
+			for (i = 0; i < workload->memWords; i++)
+				result->memory[i] = simReadMemory(sim, workload->memStart + i);
+		}
+		// The fastest run is the least disturbed by the host
+		if (runs == 1 || 1e9 * seconds / sim->totalCycles < *nsPerCycle)
+			*nsPerCycle = 1e9 * seconds / sim->totalCycles;
+		simDestroy(sim);
+	} while (total < SUITE_MIN_SECONDS);
+
+	return 1;
+}
+
+// Report the first difference from the golden results, returns 1 if there is none
+int compareGolden(const SuiteWorkload* workload, const SuiteResult* result, const SuiteResult* golden)
+{
+	int core, i;
+
+	if (result->cycles != golden->cycles)
+	{
+		fprintf(stderr, "%s: %d cycles, golden %d\n", workload->name, result->cycles, golden->cycles);
+		return 0;
+	}
+	for (core = 0; core < NUM_CORES; core++)
+		for (i = 0; i < NUM_REGS; i++)
+			if (result->registers[core][i] != golden->registers[core][i])
+			{
+				fprintf(stderr, "%s: core %d $r%d is %d, golden %d\n", workload->name, core, i,
+					result->registers[core][i], golden->registers[core][i]);
+				return 0;
+			}
+	for (i = 0; i < workload->memWords; i++)
+		if (result->memory[i] != golden->memory[i])
+		{
+			fprintf(stderr, "%s: memory %d is %d, golden %d\n", workload->name, workload->memStart + i,
+				result->memory[i], golden->memory[i]);
+			return 0;
+		}
+	return 1;
+}
+
+// Baseline speed of the workload in ns per cycle, 0 if it has none
+double readBaseline(char* fileName, const char* name)
+{
+	char line[MAX_SUITE_LINE];
+	char workloadName[MAX_SUITE_LINE];
+	double nsPerCycle, baseline = 0;
+	FILE* baselineFile = fopen(fileName, "r");
+
+	if (baselineFile == NULL)
+		return 0;
+
+	while (fgets(line, MAX_SUITE_LINE, baselineFile))
+		if (line[0] != '#' && sscanf(line, "%s %lf", workloadName, &nsPerCycle) == 2 && strcmp(workloadName, name) == 0)
+			baseline = nsPerCycle;
+
+	fclose(baselineFile);
+	return baseline;
+}
+
+int runSuite(char* dir, SuiteMode mode)
+{
+	SuiteWorkload workloads[MAX_SUITE_WORKLOADS];
+	SuiteResult result, golden;
+	Program progs[NUM_CORES];
+	char fileName[MAX_SUITE_PATH];
+	char baselineFileName[MAX_SUITE_PATH];
+	double nsPerCycle, baseline;
+	FILE* newBaseline = NULL;
+	int numWorkloads, w, i;
+	int failures = 0, regressions = 0;
+	bool ok;
+
+	if (!readSuite(dir, workloads, &numWorkloads))
+		return 0;
+
+	snprintf(baselineFileName, MAX_SUITE_PATH, "%.400s/baseline.txt", dir);
+	if (mode != SuiteCheck)
+	{
+		if ((newBaseline = fopen(baselineFileName, "w")) == NULL)
+		{
+			fprintf(stderr, "Could not write baseline %s.\n", baselineFileName);
+			return 0;
+		}
+		fprintf(newBaseline, "# Host ns per simulated cycle of each workload\n");
+	}
+
+	printf("%-20s %10s %8s %10s %10s %8s\n", "workload", "cycles", "golden", "ns/cycle", "baseline", "change");
+	for (w = 0; w < numWorkloads; w++)
+	{
+		for (i = 0; i < NUM_CORES; i++)
+		{
+			snprintf(fileName, MAX_SUITE_PATH, "%.400s/%.63s/prog%d.asm", dir, workloads[w].name, i + 1);
+			if ((progs[i] = loadProgram(fileName)) == NULL)
+				break;
+		}
+		if (i < NUM_CORES)
+		{
+			while (--i >= 0)
+				destroyProgram(progs[i]);
+			failures++;
+			continue;
+		}
+
+		ok = runWorkload(&workloads[w], progs, &result, &nsPerCycle);
+		for (i = 0; i < NUM_CORES; i++)
+			destroyProgram(progs[i]);
+		if (!ok)
+		{
+			failures++;
+			continue;
+		}
+
+		snprintf(fileName, MAX_SUITE_PATH, "%.400s/%.63s/golden.txt", dir, workloads[w].name);
+		if (mode == SuiteUpdate)
+			ok = writeGolden(fileName, &workloads[w], &result);
+		else
+			ok = readGolden(fileName, &workloads[w], &golden) && compareGolden(&workloads[w], &result, &golden);
+		if (!ok)
+			failures++;
+		if (newBaseline != NULL)
+			fprintf(newBaseline, "%-20s %.1f\n", workloads[w].name, nsPerCycle);
+
+		baseline = (mode == SuiteCheck) ? readBaseline(baselineFileName, workloads[w].name) : 0;
+		printf("%-20s %10d %8s %10.1f", workloads[w].name, result.cycles,
+			(mode == SuiteUpdate) ? "updated" : (ok ? "ok" : "FAILED"), nsPerCycle);
+		if (baseline > 0)
+		{
+			printf(" %10.1f %+7.1f%%", baseline, 100.0 * (nsPerCycle - baseline) / baseline);
+			if (nsPerCycle > baseline * (1 + SUITE_TOLERANCE))
+			{
+				printf("  REGRESSION");
+				regressions++;
+			}
+		}
+		printf("\n");
+	}
+
+	if (newBaseline != NULL)
+		fclose(newBaseline);
+	printf("%d workloads, %d failed, %d regressed\n", numWorkloads, failures, regressions);
+	return failures == 0 && regressions == 0;
+}
+
+/* Kernels of the lock comparison, each increments the word at 601 the given
+   number of times and counts its retries in r5 */
+typedef struct
+{
+	const char* name;
+	const char* source;
+} LockKernel;
+
+static const LockKernel lockKernels[] =
+{
+	{ "ll/sc lock",
+		"        add $r2, $r0, %d\n"
+		"        add $r5, $r0, 0\n"
+		"acq:    ll $r3, $r0, 600\n"
+		"        bne $r1, $r3, $r0, held\n"
+		"        add $r3, $r0, 1\n"
+		"        sc $r3, $r0, 600\n"
+		"        beq $r1, $r3, $r0, held\n"
+		"        lw $r4, $r0, 601\n"
+		"        add $r4, $r4, 1\n"
+		"        sw $r4, $r0, 601\n"
+		"        sw $r0, $r0, 600\n"
+		"        sub $r2, $r2, 1\n"
+		"        bne $r1, $r2, $r0, acq\n"
+		"        halt\n"
+		"held:   add $r5, $r5, 1\n"
+		"        jal acq\n" },
+	{ "swap lock",
+		"        add $r2, $r0, %d\n"
+		"        add $r5, $r0, 0\n"
+		"acq:    add $r3, $r0, 1\n"
+		"        swap $r3, $r0, 600\n"
+		"        bne $r1, $r3, $r0, held\n"
+		"        lw $r4, $r0, 601\n"
+		"        add $r4, $r4, 1\n"
+		"        sw $r4, $r0, 601\n"
+		"        sw $r0, $r0, 600\n"
+		"        sub $r2, $r2, 1\n"
+		"        bne $r1, $r2, $r0, acq\n"
+		"        halt\n"
+		"held:   add $r5, $r5, 1\n"
+		"        jal acq\n" },
+	{ "cas lock",
+		"        add $r2, $r0, %d\n"
+		"        add $r5, $r0, 0\n"
+		"        add $r6, $r0, 600\n"
+		"acq:    add $r3, $r0, 1\n"
+		"        cas $r3, $r6, $r0\n"
+		"        bne $r1, $r3, $r0, held\n"
+		"        lw $r4, $r0, 601\n"
+		"        add $r4, $r4, 1\n"
+		"        sw $r4, $r0, 601\n"
+		"        sw $r0, $r0, 600\n"
+		"        sub $r2, $r2, 1\n"
+		"        bne $r1, $r2, $r0, acq\n"
+		"        halt\n"
+		"held:   add $r5, $r5, 1\n"
+		"        jal acq\n" },
+	{ "ll/sc add",
+		"        add $r2, $r0, %d\n"
+		"        add $r5, $r0, 0\n"
+		"inc:    ll $r3, $r0, 601\n"
+		"        add $r3, $r3, 1\n"
+		"        sc $r3, $r0, 601\n"
+		"        beq $r1, $r3, $r0, lost\n"
+		"        sub $r2, $r2, 1\n"
+		"        bne $r1, $r2, $r0, inc\n"
+		"        halt\n"
+		"lost:   add $r5, $r5, 1\n"
+		"        jal inc\n" },
+	{ "fadd",
+		"        add $r2, $r0, %d\n"
+		"        add $r5, $r0, 0\n"
+		"inc:    add $r3, $r0, 1\n"
+		"        fadd $r3, $r0, 601\n"
+		"        sub $r2, $r2, 1\n"
+		"        bne $r1, $r2, $r0, inc\n"
+		"        halt\n" }
+};
+
+#define NUM_LOCK_KERNELS (int)(sizeof(lockKernels) / sizeof(lockKernels[0]))
+#define MAX_LOCK_SOURCE 1024
+
+int compareLocks(int sections)
+{
+	char sources[NUM_CORES][MAX_LOCK_SOURCE];
+	const char* programs[NUM_CORES];
+	SimConfig config;
+	SimStats stats;
+	SimHandle sim;
+	int kernel, cores, core, transactions, retries, counter, i, status = 1;
+
+	if (sections < 1 || sections > 2047)
+	{
+		fprintf(stderr, "Critical sections must be between 1 and 2047.\n");
+		return 0;
+	}
+	simGetDefaultConfig(&config);
+	config.maxCycles = SUITE_MAX_CYCLES;
+
+	printf("Lock throughput, %d critical sections per core\n", sections);
+	printf("%-10s %5s %9s %14s %12s %16s\n", "kernel", "cores", "cycles", "cycles/section", "bus/section",
+		"retries/section");
+	for (kernel = 0; kernel < NUM_LOCK_KERNELS; kernel++)
+		for (cores = 2; cores <= NUM_CORES; cores++)
+		{
+			for (core = 0; core < NUM_CORES; core++)
+			{
+				if (core < cores)
+					sprintf(sources[core], lockKernels[kernel].source, sections);
+				else
+					strcpy(sources[core], "        halt\n");
+				programs[core] = sources[core];
+			}
+			if ((sim = simCreate(&config, programs)) == NULL)
+				return 0;
+			simRun(sim);
+			simGetStats(sim, &stats);
+
+			transactions = 0;
+			for (i = 0; i < NumBusCommands; i++)
+				transactions += stats.busCmds[i];
+			retries = 0;
+			for (core = 0; core < cores; core++)
+				retries += simGetRegister(sim, core, 5);
+			counter = simReadMemory(sim, 601);
+			simDestroy(sim);
+
+			printf("%-10s %5d %9d %14.1f %12.2f %16.2f%s\n", lockKernels[kernel].name, cores, stats.cycles,
+				(double)stats.cycles / (cores * sections), (double)transactions / (cores * sections),
+				(double)retries / (cores * sections), (stats.halted && counter == cores * sections) ? "" : "  WRONG");
+			if (!stats.halted || counter != cores * sections)
+				status = 0;
+		}
+	return status;
+}
@@ -0,0 +1,78 @@
+#ifndef SUITE_H
+#define SUITE_H
+
+#include "Shared.h"
+#include "Pipeline2.h"
+
+#define MAX_SUITE_WORKLOADS 32
+#define MAX_SUITE_NAME 64
+#define MAX_GOLDEN_WORDS 256
+#define SUITE_MAX_CYCLES 10000000   /* A workload still running after this is reported as hung */
+#define SUITE_MIN_SECONDS 0.2       /* Repeat a workload until it took at least this long */
+#define SUITE_TOLERANCE 0.15        /* Slowdown over the baseline reported as a regression */
+
+/* Benchmark suite of multicore workloads with golden results
+ *
+ * The suite directory holds suite.txt, listing one workload per line:
+ *
+ *   spinlock   600 2
+ *
+ * that is its directory, holding prog1.asm - prog4.asm and golden.txt, and
+ * the range of memory words compared. golden.txt holds the cycles, every
+ * register of every core and the memory range of a run with the default
+ * configuration:
+ *
+ *   cycles 4711
+ *   regs 0 0 0 25 ...
+ *   mem 600 0 100
+ *
+ * baseline.txt holds the host nanoseconds per simulated cycle of each
+ * workload, a workload more than SUITE_TOLERANCE slower is a regression.
+ * The baseline depends on the host, so it is recorded on each machine.
+ */
+
+typedef enum
+{
+	SuiteCheck = 0,     /* Compare with the golden results and the baseline */
+	SuiteBaseline,      /* Compare with the golden results, record the baseline */
+	SuiteUpdate         /* Rewrite the golden results and the baseline */
+} SuiteMode;
+
+typedef struct
+{
+	char name[MAX_SUITE_NAME];
+	int memStart;
+	int memWords;
+} SuiteWorkload;
+
+/* Final state of a run */
+typedef struct
+{
+	int cycles;
+	int registers[NUM_CORES][NUM_REGS];
+	int memory[MAX_GOLDEN_WORDS];
+} SuiteResult;
+
+/* Read the workloads of dir/suite.txt, returns 0 on errors */
+int readSuite(char* dir, SuiteWorkload workloads[], int* numWorkloads);
+int readGolden(char* fileName, const SuiteWorkload* workload, SuiteResult* golden);
+int writeGolden(char* fileName, const SuiteWorkload* workload, const SuiteResult* result);
+
+/* Run a workload to completion with the default configuration, then again
+   until it has run SUITE_MIN_SECONDS, keeping the speed of the fastest run.
+   Returns 0 if it does not halt within SUITE_MAX_CYCLES. */
+int runWorkload(const SuiteWorkload* workload, Program progs[], SuiteResult* result, double* nsPerCycle);
+
+/* Run every workload of the suite and print a table of cycles, golden result
+   checks and host speed against the baseline. Returns 1 if every workload
+   matched and none regressed. */
+int runSuite(char* dir, SuiteMode mode);
+
+/* Run a counter protected by a lock built from LL/SC, SWAP and CAS, and a
+   counter incremented by LL/SC and by FADD, with 2 to NUM_CORES cores each
+   doing the given number of critical sections while the others halt. Prints
+   simulated cycles, bus transactions and retries per critical section.
+   Returns 0 if a counter ends up wrong. */
+int compareLocks(int sections);
+
+#endif
@@ -0,0 +1,348 @@
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "Sweep.h"
+
+#define MAX_GRID_LINE 256
+
+/* Work shared by the sweep threads */
+typedef struct
+{
+	const SweepGrid* grid;
+	Program* progs;
+	SweepResult* results;
+	int numConfigs;
+	int nextConfig;
+	pthread_mutex_t lock;
+} SweepJobs;
+
+void getDefaultSweepGrid(SweepGrid* grid)
+{
+	grid->cacheSizes[0] = CACHE_SIZE;
+	grid->numCacheSizes = 1;
+	grid->associativities[0] = ASSOCIATIVITY;
+	grid->numAssociativities = 1;
+	grid->memLatencies[0] = MEM_LATENCY;
+	grid->numMemLatencies = 1;
+	grid->forwardings[0] = 1;
+	grid->numForwardings = 1;
+	grid->predictors[0] = PredictBimodal;
+	grid->numPredictors = 1;
+	grid->issueWidths[0] = 1;
+	grid->numIssueWidths = 1;
+	grid->cachePorts[0] = 1;
+	grid->numCachePorts = 1;
+	grid->memoryModels[0] = SequentialConsistency;
+	grid->numMemoryModels = 1;
+	grid->maxCycles = 0;
+	grid->fastForward = 0;
+	grid->warmCaches = True;
+	grid->numThreads = 0;
+}
+
+// Read the values following the parameter name, returns the number read
+int readGridValues(char* line, int values[])
+{
+	int n = 0;
+	char* token = strtok(line, " \t\r\n");
+
+	while ((token = strtok(NULL, " \t\r\n")) != NULL && n < MAX_SWEEP_VALUES)
+		values[n++] = atoi(token);
+
+	return n;
+}
+
+int readSweepGrid(char* fileName, SweepGrid* grid)
+{
+	char line[MAX_GRID_LINE];
+	char name[MAX_GRID_LINE];
+	int values[MAX_SWEEP_VALUES];
+	int n, i;
+	FILE* gridFile = fopen(fileName, "r");
+
+	if (gridFile == NULL)
+	{
+		fprintf(stderr, "Could not open sweep grid %s.\n", fileName);
+		return 0;
+	}
+
+	getDefaultSweepGrid(grid);
+	while (fgets(line, MAX_GRID_LINE, gridFile))
+	{
+		if (strchr(line, '#') != NULL)
+			*strchr(line, '#') = '\0';
+		if (sscanf(line, "%s", name) != 1)
+			continue;
+
+		n = readGridValues(line, values);
+		if (n == 0)
+		{
+			fprintf(stderr, "Sweep parameter %s has no values.\n", name);
+			fclose(gridFile);
+			return 0;
+		}
+
+		if (strcmp(name, "cache_size") == 0)
+		{
+			memcpy(grid->cacheSizes, values, n * sizeof(int));
+			grid->numCacheSizes = n;
+		}
+		else if (strcmp(name, "associativity") == 0)
+		{
+			memcpy(grid->associativities, values, n * sizeof(int));
+			grid->numAssociativities = n;
+		}
+		else if (strcmp(name, "mem_latency") == 0)
+		{
+			memcpy(grid->memLatencies, values, n * sizeof(int));
+			grid->numMemLatencies = n;
+		}
+		else if (strcmp(name, "forwarding") == 0)
+		{
+			memcpy(grid->forwardings, values, n * sizeof(int));
+			grid->numForwardings = n;
+		}
+		else if (strcmp(name, "predictor") == 0)
+		{
+			for (i = 0; i < n; i++)
+				if (values[i] < 0 || values[i] >= NumPredictorSchemes)
+				{
+					fprintf(stderr, "Unknown branch predictor %d.\n", values[i]);
+					fclose(gridFile);
+					return 0;
+				}
+			memcpy(grid->predictors, values, n * sizeof(int));
+			grid->numPredictors = n;
+		}
+		else if (strcmp(name, "issue_width") == 0)
+		{
+			memcpy(grid->issueWidths, values, n * sizeof(int));
+			grid->numIssueWidths = n;
+		}
+		else if (strcmp(name, "cache_ports") == 0)
+		{
+			memcpy(grid->cachePorts, values, n * sizeof(int));
+			grid->numCachePorts = n;
+		}
+		else if (strcmp(name, "memory_model") == 0)
+		{
+			for (i = 0; i < n; i++)
+				if (values[i] < 0 || values[i] >= NumMemoryModels)
+				{
+					fprintf(stderr, "Unknown memory model %d.\n", values[i]);
+					fclose(gridFile);
+					return 0;
+				}
+			memcpy(grid->memoryModels, values, n * sizeof(int));
+			grid->numMemoryModels = n;
+		}
+		else if (strcmp(name, "max_cycles") == 0)
+			grid->maxCycles = values[0];
+		else if (strcmp(name, "fast_forward") == 0)
+		{
+			grid->fastForward = values[0];
+			grid->warmCaches = (n < 2 || values[1] != 0);
+		}
+		else if (strcmp(name, "threads") == 0)
+			grid->numThreads = values[0];
+		else
+		{
+			fprintf(stderr, "Unknown sweep parameter %s.\n", name);
+			fclose(gridFile);
+			return 0;
+		}
+	}
+
+	fclose(gridFile);
+	return 1;
+}
+
+int getNumSweepConfigs(const SweepGrid* grid)
+{
+	return grid->numCacheSizes * grid->numAssociativities * grid->numMemLatencies * grid->numForwardings * grid->numPredictors *
+		   grid->numIssueWidths * grid->numCachePorts * grid->numMemoryModels;
+}
+
+int getHostProcessorCount()
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return (n > 0) ? (int)n : 1;
+}
+
+// Configuration number i of the grid, cache size varies slowest
+void getSweepConfig(const SweepGrid* grid, int i, SimConfig* config)
+{
+	getDefaultConfig(config);
+	config->memoryModel   = (MemoryModel)grid->memoryModels[i % grid->numMemoryModels];
+	i /= grid->numMemoryModels;
+	config->cachePorts    = grid->cachePorts[i % grid->numCachePorts];
+	i /= grid->numCachePorts;
+	config->issueWidth    = grid->issueWidths[i % grid->numIssueWidths];
+	i /= grid->numIssueWidths;
+	config->predictor     = (PredictorScheme)grid->predictors[i % grid->numPredictors];
+	i /= grid->numPredictors;
+	config->forwarding    = grid->forwardings[i % grid->numForwardings] != 0;
+	i /= grid->numForwardings;
+	config->memLatency    = grid->memLatencies[i % grid->numMemLatencies];
+	i /= grid->numMemLatencies;
+	config->associativity = grid->associativities[i % grid->numAssociativities];
+	i /= grid->numAssociativities;
+	config->cacheSize     = grid->cacheSizes[i];
+	config->maxCycles     = grid->maxCycles;
+	config->fastForward   = grid->fastForward;
+	config->warmCaches    = grid->warmCaches;
+	config->busTraceFileName = NULL;
+}
+
+void runSweepConfig(SweepJobs* jobs, int i)
+{
+	int j;
+	SweepResult* result = &jobs->results[i];
+	Computer comp;
+	Pipeline* pipe;
+	StatsRegistry reg;
+
+	getSweepConfig(jobs->grid, i, &result->config);
+	result->valid = False;
+
+	comp = CreateNewComputer();
+	if (comp == NULL)
+		return;
+	if (!initializeComputerWithPrograms(comp, jobs->progs, &result->config))
+	{
+		destroyComputer(comp);
+		return;
+	}
+
+	runComputer(comp);
+
+	// Through the registry, so a program's region of interest or reset bounds the results
+	reg = comp->stats;
+	result->valid = True;
+	result->halted = True;
+	result->cycles = readRegisteredCounter(reg, &comp->totalCycles);
+	for (j = 0; j < NUM_CORES; j++)
+	{
+		pipe = comp->pipes[j];
+		result->halted = result->halted && pipe->totally_done && !pipe->faulted;
+		result->coreCycles[j] = readRegisteredCounter(reg, &pipe->totalCycles);
+		result->instructions[j] = readRegisteredCounter(reg, &pipe->wbUtil);
+		result->hits[j] = readRegisteredCounter(reg, &comp->caches[j]->hits);
+		result->misses[j] = readRegisteredCounter(reg, &comp->caches[j]->misses);
+		result->stallCyclesAvoided[j] = readRegisteredCounter(reg, &pipe->stallCyclesAvoided);
+		result->storeCyclesHidden[j] = readRegisteredCounter(reg, &pipe->storeCyclesHidden);
+		result->branches[j] = readRegisteredCounter(reg, &pipe->branches);
+		result->mispredictions[j] = readRegisteredCounter(reg, &pipe->mispredictions);
+		result->pairedIssues[j] = readRegisteredCounter(reg, &pipe->pairedIssues);
+	}
+	for (j = 0; j < NumBusCommands; j++)
+		result->busCmds[j] = readRegisteredCounter(reg, &comp->bus->cmdCount[j]);
+
+	destroyComputer(comp);
+}
+
+void* sweepThread(void* arg)
+{
+	SweepJobs* jobs = (SweepJobs*)arg;
+	int i;
+
+	while (1)
+	{
+		pthread_mutex_lock(&jobs->lock);
+		i = jobs->nextConfig++;
+		pthread_mutex_unlock(&jobs->lock);
+
+		if (i >= jobs->numConfigs)
+			break;
+		runSweepConfig(jobs, i);
+	}
+	return NULL;
+}
+
+void writeSweepResults(FILE* out, SweepResult* results, int numConfigs)
+{
+	int i, j;
+
+	fprintf(out, "%-10s %-5s %-7s %-3s %-9s %-5s %-5s %-5s %-10s %-6s", "cache_size", "assoc", "mem_lat", "fwd", "predictor",
+			"width", "ports", "model", "cycles", "halted");
+	for (j = 0; j < NUM_CORES; j++)
+		fprintf(out, " %7s%d %7s%d %7s%d %7s%d %7s%d %7s%d %7s%d %7s%d", "instr", j, "hits", j, "misses", j, "avoid", j,
+				"hidden", j, "branch", j, "mispred", j, "paired", j);
+	fprintf(out, " %8s %8s %8s\n", "busrd", "busrdx", "flush");
+
+	for (i = 0; i < numConfigs; i++)
+	{
+		fprintf(out, "%-10d %-5d %-7d %-3d %-9s %-5d %-5d %-5s ", results[i].config.cacheSize, results[i].config.associativity,
+				results[i].config.memLatency, results[i].config.forwarding, getPredictorSchemeName(results[i].config.predictor),
+				results[i].config.issueWidth, results[i].config.cachePorts, getMemoryModelName(results[i].config.memoryModel));
+		if (!results[i].valid)
+		{
+			fprintf(out, "invalid configuration\n");
+			continue;
+		}
+		fprintf(out, "%-10d %-6s", results[i].cycles, results[i].halted ? "yes" : "no");
+		for (j = 0; j < NUM_CORES; j++)
+			fprintf(out, " %8d %8d %8d %8d %8d %8d %8d %8d", results[i].instructions[j], results[i].hits[j], results[i].misses[j],
+					results[i].stallCyclesAvoided[j], results[i].storeCyclesHidden[j], results[i].branches[j],
+					results[i].mispredictions[j], results[i].pairedIssues[j]);
+		fprintf(out, " %8d %8d %8d\n", results[i].busCmds[BusRd], results[i].busCmds[BusRdx], results[i].busCmds[Flush]);
+	}
+}
+
+int runSweep(const SweepGrid* grid, Program progs[], char* resultsFileName)
+{
+	SweepJobs jobs;
+	pthread_t* threads;
+	int numThreads, numStarted, i;
+	FILE* out;
+
+	jobs.grid = grid;
+	jobs.progs = progs;
+	jobs.numConfigs = getNumSweepConfigs(grid);
+	jobs.nextConfig = 0;
+	jobs.results = (SweepResult*)malloc(jobs.numConfigs * sizeof(SweepResult));
+	if (jobs.results == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for sweep results.\n");
+		return 0;
+	}
+
+	numThreads = (grid->numThreads > 0) ? grid->numThreads : getHostProcessorCount();
+	if (numThreads > jobs.numConfigs)
+		numThreads = jobs.numConfigs;
+	threads = (pthread_t*)malloc(numThreads * sizeof(pthread_t));
+	if (threads == NULL)
+	{
+		fprintf(stderr, "Could not allocate memory for sweep threads.\n");
+		free(jobs.results);
+		return 0;
+	}
+
+	pthread_mutex_init(&jobs.lock, NULL);
+	for (numStarted = 0; numStarted < numThreads; numStarted++)
+		if (pthread_create(&threads[numStarted], NULL, sweepThread, &jobs) != 0)
+		{
+			fprintf(stderr, "Could only start %d of %d sweep threads, running the rest here.\n", numStarted, numThreads);
+			break;
+		}
+	if (numStarted < numThreads)
+		sweepThread(&jobs);
+	for (i = 0; i < numStarted; i++)
+		pthread_join(threads[i], NULL);
+	pthread_mutex_destroy(&jobs.lock);
+	free(threads);
+
+	out = (resultsFileName != NULL) ? fopen(resultsFileName, "w") : stdout;
+	if (out == NULL)
+	{
+		fprintf(stderr, "Could not open sweep results file %s.\n", resultsFileName);
+		free(jobs.results);
+		return 0;
+	}
+	writeSweepResults(out, jobs.results, jobs.numConfigs);
+	if (out != stdout)
+		fclose(out);
+
+	free(jobs.results);
+	return 1;
+}
@@ -0,0 +1,79 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "Shared.h"
+#include "MultiCoreComputer.h"
+
+#define MAX_SWEEP_VALUES 16
+
+/* Grid of configurations, every combination of the listed values is run.
+ *
+ * The grid file has one parameter per line followed by its values,
+ * '#' starts a comment:
+ *
+ *   cache_size    64 128 256
+ *   associativity 1 2 4
+ *   mem_latency   16 64
+ *   forwarding    0 1
+ *   predictor     0 1 2 3
+ *   issue_width   1 2
+ *   cache_ports   1 2
+ *   memory_model  0 1
+ *   max_cycles    1000000
+ *   fast_forward  100000 1
+ *   threads       0
+ */
+typedef struct
+{
+	int cacheSizes[MAX_SWEEP_VALUES];
+	int numCacheSizes;
+	int associativities[MAX_SWEEP_VALUES];
+	int numAssociativities;
+	int memLatencies[MAX_SWEEP_VALUES];
+	int numMemLatencies;
+	int forwardings[MAX_SWEEP_VALUES];     /* 0 = stall-only pipelines, 1 = forwarding */
+	int numForwardings;
+	int predictors[MAX_SWEEP_VALUES];      /* PredictorScheme values */
+	int numPredictors;
+	int issueWidths[MAX_SWEEP_VALUES];
+	int numIssueWidths;
+	int cachePorts[MAX_SWEEP_VALUES];
+	int numCachePorts;
+	int memoryModels[MAX_SWEEP_VALUES];    /* MemoryModel values */
+	int numMemoryModels;
+	int maxCycles;          /* Cycle limit of every run, 0 = no limit */
+	int fastForward;        /* Instructions per core run functionally first, then 1 to warm the caches */
+	bool warmCaches;
+	int numThreads;         /* 0 = one thread per host processor */
+} SweepGrid;
+
+/* Outcome of one configuration */
+typedef struct
+{
+	SimConfig config;
+	bool valid;             /* False when the computer could not be built */
+	bool halted;            /* All cores halted before the cycle limit */
+	int cycles;
+	int coreCycles[NUM_CORES];
+	int instructions[NUM_CORES];
+	int hits[NUM_CORES];
+	int misses[NUM_CORES];
+	int stallCyclesAvoided[NUM_CORES];
+	int storeCyclesHidden[NUM_CORES];
+	int branches[NUM_CORES];
+	int mispredictions[NUM_CORES];
+	int pairedIssues[NUM_CORES];   /* Cycles two instructions issued */
+	int busCmds[NumBusCommands];
+} SweepResult;
+
+void getDefaultSweepGrid(SweepGrid* grid);
+int readSweepGrid(char* fileName, SweepGrid* grid);
+int getNumSweepConfigs(const SweepGrid* grid);
+int getHostProcessorCount();
+
+/* Run every configuration of the grid on the programs, which are parsed once
+   and shared read only by all runs, and write one results table.
+   Returns 1 on success, 0 on failure. */
+int runSweep(const SweepGrid* grid, Program progs[], char* resultsFileName);
+
+#endif
@@ -0,0 +1,9 @@
+; Each core increments its own word, the four words are adjacent
+        add $r2, $r0, 100       ; iterations
+        add $r3, $r0, 1002      ; word of core 2
+loop:   lw $r4, $r3, 0
+        add $r4, $r4, 1
+        sw $r4, $r3, 0
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, loop
+        halt
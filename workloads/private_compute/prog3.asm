@@ -0,0 +1,13 @@
+; Register-only hash loop, one store of the result
+        add $r2, $r0, 200       ; iterations
+        add $r3, $r0, 3         ; seed of core 2
+loop:   mul $r3, $r3, 31
+        add $r3, $r3, $r2
+        xor $r4, $r3, $r2
+        sra $r5, $r4, 3
+        add $r3, $r3, $r5
+        and $r3, $r3, 0x7ff
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, loop
+        sw $r3, $r0, 952
+        halt
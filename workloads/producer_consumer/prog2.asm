@@ -0,0 +1,12 @@
+; Consumer: empties the mailbox at 800, the sum goes to 802
+        add $r2, $r0, 20        ; items
+        add $r5, $r0, 0         ; sum
+wait:   lw $r4, $r0, 801
+        beq $r1, $r4, $r0, wait ; mailbox empty
+        lw $r3, $r0, 800
+        add $r5, $r5, $r3
+        sw $r0, $r0, 801
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, wait
+        sw $r5, $r0, 802
+        halt
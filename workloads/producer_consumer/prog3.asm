@@ -0,0 +1,12 @@
+; Producer: fills a one-word mailbox at 810 guarded by a full flag at 811
+        add $r2, $r0, 20        ; items
+        add $r3, $r0, 0         ; value
+wait:   lw $r4, $r0, 811
+        bne $r1, $r4, $r0, wait ; mailbox still full
+        add $r3, $r3, 3
+        sw $r3, $r0, 810
+        add $r4, $r0, 1
+        sw $r4, $r0, 811
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, wait
+        halt
@@ -0,0 +1,17 @@
+; Test-and-set lock at 600 built from ll/sc, protecting a counter at 601
+        add $r2, $r0, 25        ; critical sections
+        add $r5, $r0, 0         ; failed acquires
+acq:    ll $r3, $r0, 600
+        bne $r1, $r3, $r0, held
+        add $r3, $r0, 1
+        sc $r3, $r0, 600
+        beq $r1, $r3, $r0, held ; lost the race
+        lw $r4, $r0, 601        ; critical section
+        add $r4, $r4, 1
+        sw $r4, $r0, 601
+        sw $r0, $r0, 600        ; release
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, acq
+        halt
+held:   add $r5, $r5, 1
+        jal acq
@@ -0,0 +1,18 @@
+; Write a private array larger than the cache, then sum it
+        add $r2, $r0, 320       ; words
+        add $r3, $r0, 5         ; array of core 3 at 5120
+        sll $r3, $r3, 10
+        add $r4, $r0, 0
+fill:   add $r5, $r3, $r4
+        sw $r4, $r5, 0
+        add $r4, $r4, 1
+        blt $r1, $r4, $r2, fill
+        add $r4, $r0, 0
+        add $r6, $r0, 0         ; sum
+sum:    add $r5, $r3, $r4
+        lw $r7, $r5, 0
+        add $r6, $r6, $r7
+        add $r4, $r4, 1
+        blt $r1, $r4, $r2, sum
+        sw $r6, $r0, 903
+        halt
@@ -0,0 +1,278 @@
+; Synthetic workload of core 1: working set 384, 768 accesses, 60% reads, 40% shared by 4 cores,
+; stride 3, 25% of shared accesses locked, 2 compute instructions per access, seed 7
+        add $r2, $r0, 24
+        add $r3, $r0, 2
+        sll $r3, $r3, 11
+        add $r3, $r3, 768
+        add $r4, $r0, 2
+        sll $r4, $r4, 11
+        add $r7, $r0, 384
+        add $r8, $r0, 3
+loop:
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G0
+        sub $r5, $r5, $r7
+G0:
+        or $r13, $r11, $r10
+        xor $r11, $r11, $r2
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G1
+        sub $r6, $r6, $r7
+G1:
+        xor $r11, $r11, $r10
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G2
+        sub $r5, $r5, $r7
+G2:
+        srl $r11, $r11, 3
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G3
+        sub $r5, $r5, $r7
+G3:
+        or $r13, $r11, $r10
+        and $r11, $r11, $r13
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G4
+        sub $r6, $r6, $r7
+G4:
+        sll $r11, $r11, 1
+        sll $r11, $r11, 1
+        add $r9, $r4, $r6
+        sw $r11, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G5
+        sub $r6, $r6, $r7
+G5:
+        or $r13, $r11, $r10
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G6
+        sub $r5, $r5, $r7
+G6:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r2
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G7
+        sub $r6, $r6, $r7
+G7:
+        and $r11, $r11, $r13
+        or $r13, $r11, $r10
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G8
+        sub $r5, $r5, $r7
+G8:
+        or $r13, $r11, $r10
+        srl $r11, $r11, 3
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G9
+        sub $r6, $r6, $r7
+G9:
+        or $r13, $r11, $r10
+        srl $r11, $r11, 3
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G10
+        sub $r5, $r5, $r7
+G10:
+        xor $r11, $r11, $r10
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G11
+        sub $r5, $r5, $r7
+G11:
+        or $r13, $r11, $r10
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G12
+        sub $r5, $r5, $r7
+G12:
+        xor $r11, $r11, $r2
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G13
+        sub $r5, $r5, $r7
+G13:
+        sll $r11, $r11, 1
+        and $r11, $r11, $r13
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G14
+        sub $r5, $r5, $r7
+G14:
+        srl $r11, $r11, 3
+        srl $r11, $r11, 3
+        add $r9, $r4, $r6
+        sw $r11, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G15
+        sub $r6, $r6, $r7
+G15:
+        sll $r11, $r11, 1
+        and $r11, $r11, $r13
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G16
+        sub $r5, $r5, $r7
+G16:
+        or $r13, $r11, $r10
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G17
+        sub $r5, $r5, $r7
+G17:
+        and $r11, $r11, $r13
+        srl $r11, $r11, 3
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G18
+        sub $r5, $r5, $r7
+G18:
+        xor $r11, $r11, $r2
+        srl $r11, $r11, 3
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G19
+        sub $r5, $r5, $r7
+G19:
+        xor $r11, $r11, $r10
+        srl $r11, $r11, 3
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G20
+        sub $r5, $r5, $r7
+G20:
+        srl $r11, $r11, 3
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G21
+        sub $r5, $r5, $r7
+G21:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r10
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G22
+        sub $r6, $r6, $r7
+G22:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G23
+        sub $r5, $r5, $r7
+G23:
+        and $r11, $r11, $r13
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G24
+        sub $r5, $r5, $r7
+G24:
+        xor $r11, $r11, $r2
+        and $r11, $r11, $r13
+G25:     ll $r12, $r0, 64
+        bne $r1, $r12, $r0, G25
+        add $r12, $r0, 1
+        sc $r12, $r0, 64
+        beq $r1, $r12, $r0, G25
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G26
+        sub $r6, $r6, $r7
+G26:
+        add $r10, $r10, 1
+        sw $r10, $r9, 0
+        sw $r0, $r0, 64     ; release
+        xor $r11, $r11, $r2
+        xor $r11, $r11, $r2
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G27
+        sub $r6, $r6, $r7
+G27:
+        sll $r11, $r11, 1
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G28
+        sub $r5, $r5, $r7
+G28:
+        srl $r11, $r11, 3
+        xor $r11, $r11, $r10
+        add $r9, $r4, $r6
+        sw $r11, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G29
+        sub $r6, $r6, $r7
+G29:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G30
+        sub $r5, $r5, $r7
+G30:
+        or $r13, $r11, $r10
+        and $r11, $r11, $r13
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G31
+        sub $r6, $r6, $r7
+G31:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G32
+        sub $r5, $r5, $r7
+G32:
+        xor $r11, $r11, $r2
+        srl $r11, $r11, 3
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, loop
+        halt
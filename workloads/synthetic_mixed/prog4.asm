@@ -0,0 +1,302 @@
+; Synthetic workload of core 3: working set 384, 768 accesses, 60% reads, 40% shared by 4 cores,
+; stride 3, 25% of shared accesses locked, 2 compute instructions per access, seed 7
+        add $r2, $r0, 24
+        add $r3, $r0, 2
+        sll $r3, $r3, 11
+        add $r3, $r3, 1536
+        add $r4, $r0, 2
+        sll $r4, $r4, 11
+        add $r7, $r0, 384
+        add $r8, $r0, 3
+loop:
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G0
+        sub $r5, $r5, $r7
+G0:
+        srl $r11, $r11, 3
+        srl $r11, $r11, 3
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G1
+        sub $r5, $r5, $r7
+G1:
+        sll $r11, $r11, 1
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G2
+        sub $r5, $r5, $r7
+G2:
+        sll $r11, $r11, 1
+        or $r13, $r11, $r10
+G3:     ll $r12, $r0, 64
+        bne $r1, $r12, $r0, G3
+        add $r12, $r0, 1
+        sc $r12, $r0, 64
+        beq $r1, $r12, $r0, G3
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G4
+        sub $r6, $r6, $r7
+G4:
+        add $r10, $r10, 1
+        sw $r10, $r9, 0
+        sw $r0, $r0, 64     ; release
+        xor $r11, $r11, $r10
+        and $r11, $r11, $r13
+G5:     ll $r12, $r0, 64
+        bne $r1, $r12, $r0, G5
+        add $r12, $r0, 1
+        sc $r12, $r0, 64
+        beq $r1, $r12, $r0, G5
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G6
+        sub $r6, $r6, $r7
+G6:
+        add $r10, $r10, 1
+        sw $r10, $r9, 0
+        sw $r0, $r0, 64     ; release
+        sll $r11, $r11, 1
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G7
+        sub $r5, $r5, $r7
+G7:
+        or $r13, $r11, $r10
+        xor $r11, $r11, $r10
+G8:     ll $r12, $r0, 64
+        bne $r1, $r12, $r0, G8
+        add $r12, $r0, 1
+        sc $r12, $r0, 64
+        beq $r1, $r12, $r0, G8
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G9
+        sub $r6, $r6, $r7
+G9:
+        add $r10, $r10, 1
+        sw $r10, $r9, 0
+        sw $r0, $r0, 64     ; release
+        xor $r11, $r11, $r2
+        srl $r11, $r11, 3
+G10:     ll $r12, $r0, 64
+        bne $r1, $r12, $r0, G10
+        add $r12, $r0, 1
+        sc $r12, $r0, 64
+        beq $r1, $r12, $r0, G10
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G11
+        sub $r6, $r6, $r7
+G11:
+        add $r10, $r10, 1
+        sw $r10, $r9, 0
+        sw $r0, $r0, 64     ; release
+        xor $r11, $r11, $r2
+        xor $r11, $r11, $r10
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G12
+        sub $r6, $r6, $r7
+G12:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G13
+        sub $r5, $r5, $r7
+G13:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G14
+        sub $r5, $r5, $r7
+G14:
+        and $r11, $r11, $r13
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G15
+        sub $r5, $r5, $r7
+G15:
+        xor $r11, $r11, $r10
+        xor $r11, $r11, $r2
+        add $r9, $r4, $r6
+        sw $r11, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G16
+        sub $r6, $r6, $r7
+G16:
+        xor $r11, $r11, $r10
+        or $r13, $r11, $r10
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G17
+        sub $r5, $r5, $r7
+G17:
+        sll $r11, $r11, 1
+        and $r11, $r11, $r13
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G18
+        sub $r5, $r5, $r7
+G18:
+        xor $r11, $r11, $r2
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G19
+        sub $r5, $r5, $r7
+G19:
+        sll $r11, $r11, 1
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G20
+        sub $r5, $r5, $r7
+G20:
+        and $r11, $r11, $r13
+        srl $r11, $r11, 3
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G21
+        sub $r6, $r6, $r7
+G21:
+        xor $r11, $r11, $r2
+        and $r11, $r11, $r13
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G22
+        sub $r5, $r5, $r7
+G22:
+        and $r11, $r11, $r13
+        or $r13, $r11, $r10
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G23
+        sub $r6, $r6, $r7
+G23:
+        or $r13, $r11, $r10
+        srl $r11, $r11, 3
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G24
+        sub $r5, $r5, $r7
+G24:
+        xor $r11, $r11, $r2
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G25
+        sub $r5, $r5, $r7
+G25:
+        and $r11, $r11, $r13
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G26
+        sub $r5, $r5, $r7
+G26:
+        xor $r11, $r11, $r2
+        and $r11, $r11, $r13
+        add $r9, $r4, $r6
+        sw $r11, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G27
+        sub $r6, $r6, $r7
+G27:
+        xor $r11, $r11, $r10
+        xor $r11, $r11, $r2
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G28
+        sub $r5, $r5, $r7
+G28:
+        sll $r11, $r11, 1
+        or $r13, $r11, $r10
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G29
+        sub $r5, $r5, $r7
+G29:
+        xor $r11, $r11, $r2
+        xor $r11, $r11, $r10
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G30
+        sub $r5, $r5, $r7
+G30:
+        srl $r11, $r11, 3
+        srl $r11, $r11, 3
+        add $r9, $r4, $r6
+        sw $r11, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G31
+        sub $r6, $r6, $r7
+G31:
+        sll $r11, $r11, 1
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        sw $r11, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G32
+        sub $r5, $r5, $r7
+G32:
+        xor $r11, $r11, $r2
+        or $r13, $r11, $r10
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G33
+        sub $r6, $r6, $r7
+G33:
+        sll $r11, $r11, 1
+        and $r11, $r11, $r13
+        add $r9, $r4, $r6
+        lw $r10, $r9, 0
+        add $r6, $r6, $r8
+        blt $r1, $r6, $r7, G34
+        sub $r6, $r6, $r7
+G34:
+        srl $r11, $r11, 3
+        sll $r11, $r11, 1
+        add $r9, $r3, $r5
+        lw $r10, $r9, 0
+        add $r5, $r5, $r8
+        blt $r1, $r5, $r7, G35
+        sub $r5, $r5, $r7
+G35:
+        sll $r11, $r11, 1
+        xor $r11, $r11, $r10
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, loop
+        halt
@@ -0,0 +1,12 @@
+; Every core reads and writes the same word without synchronization
+        add $r2, $r0, 50        ; iterations
+        add $r3, $r0, 1         ; amount of core 0
+        add $r5, $r0, 0         ; values seen
+loop:   lw $r4, $r0, 600
+        add $r5, $r5, $r4
+        add $r4, $r4, $r3
+        sw $r4, $r0, 600
+        sub $r2, $r2, 1
+        bne $r1, $r2, $r0, loop
+        sw $r5, $r0, 601
+        halt